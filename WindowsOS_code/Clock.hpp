@@ -0,0 +1,84 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	Clock definition and implementation
+*
+*/
+
+// Multiple inclusion guards to avoid linker errors
+// In case this file is included in multiple source files
+// we want to avoid re-compilations
+#ifndef CLOCK_HPP
+#define CLOCK_HPP
+
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+//*** Clock class ***//
+
+// Timestamps of the Exchange: requests on creation, orders on submission and on arrival
+// in the book, fills on execution. A timestamp is a plain integer, in nanoseconds since
+// epoch, thus taking one is a single read of the monotonic clock (a vDSO call on Linux,
+// QueryPerformanceCounter on Windows) and takes no lock.
+// The wall clock is read once, the first time the Clock is used, and anchors the monotonic
+// clock to it. Timestamps therefore never go backwards when the system time is adjusted,
+// and differences between them are exact latencies.
+// Text is produced only at report time, with format(). The timezone conversion takes
+// the libc timezone lock, thus it is kept away from the request and matching paths
+class Clock {
+public:
+	// Nanoseconds since epoch, advanced by the monotonic clock
+	static inline long long now() {
+		const Anchor & a = anchor();
+		return a.wall + (steady() - a.steady);
+	}
+
+	// Local time of a timestamp, as text. Report time only. The reentrant localtime is
+	// used, thus reports can be formatted on several threads at once
+	static std::string format(long long timestamp) {
+		std::time_t t = (std::time_t)(timestamp / 1000000000LL);
+		std::tm local;
+#if defined(_WIN32)
+		localtime_s(&local, &t);
+#else
+		localtime_r(&t, &local);
+#endif
+		std::stringstream ss;
+		ss << std::put_time(&local, "%F %T EST");
+		return ss.str();
+	}
+
+private:
+	// Wall clock and monotonic clock read at the same moment
+	struct Anchor {
+		long long	wall;
+		long long	steady;
+
+		Anchor() : steady(Clock::steady()) {
+			wall = std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::system_clock::now().time_since_epoch()).count();
+		}
+	};
+
+	// Built once, by the first thread that takes a timestamp
+	static inline const Anchor & anchor() {
+		static const Anchor a;
+		return a;
+	}
+
+	static inline long long steady() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// Static interface only
+	Clock();
+};
+
+#endif // !CLOCK_HPP
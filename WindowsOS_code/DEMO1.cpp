@@ -95,6 +95,7 @@ int main() {
 	submission4.join();
 	submission5.join();
 	submission6.join();
+	NYSE.flush();
 
 	// Delete the last two trades
 	NYSE.delete_trade(t6, r6, "SELL", "BABA");
@@ -104,6 +105,7 @@ int main() {
 
 	// Edit the existing AMZN order to ask for $1000
 	NYSE.edit_trade_price(t4, r4, "SELL", "AMZN", 1000);
+	NYSE.flush();
 	
 	// Check remaining available trades
 	std::cout << "\n***\n";
@@ -4,118 +4,290 @@
 *
 *  =================================================================
 *
-*	Stock Exchange Matching Engine Demo 1:
-*		Stress Testing with high volume async requests
+*	Stock Exchange Matching Engine Demo 2:
+*		Open-loop load generator with latency percentiles
+*
+*	Usage: DEMO2 [rate] [seconds] [producers] [engines] [blocking|spin|rtc]
+*		rate:		orders per second offered by all producers together (default 100000)
+*		seconds:	length of the run (default 2)
+*		producers:	broker threads injecting the orders (default 2)
+*		engines:	matching engines of the Exchange (default 1)
+*		mode:		wait strategy of the engines, or run to completion (default blocking)
 *
 */
 
- // Necessary libraries
+// Necessary libraries
 #include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
 #include "Exchange.hpp"
+#include "LatencyHistogram.hpp"
+
+//*** Load generator ***//
+
+// Every producer sends its orders on a fixed schedule (open loop): order i is due at
+// start + i * interval, whether or not the Exchange kept up with the orders before it.
+// Its latency is measured from the time it was due, not from the time it was sent, thus a
+// stall of the Exchange shows up in the latency of every order it delayed and not only in
+// the one order that was stuck (coordinated omission). The latency from the actual send
+// is kept as well, to show the difference.
+// The orders are IOC orders that take the liquidity of a deep book, thus every order gets
+// exactly one acknowledgement, its fill, through the producer's execution reports. The
+// acknowledgement carries the engine's timestamp of the fill, thus the producer can poll
+// its reports between two sends without adding its own delay to the measure.
+
+// Price of the resting liquidity, and of the orders that take it
+static const double bid_price = 99.99;
+static const double ask_price = 100.01;
+
+// A producer closer than this to its next order spins instead of yielding, in nanoseconds
+static const long long spin_window = 20000;
+
+// Send times of an order waiting for its acknowledgement
+struct Pending {
+	long long	due;		// Time the schedule sent it at
+	long long	sent;		// Time it was actually sent at
+};
+
+// One broker thread and what it measured. The trader and its subscription belong to
+// main(), thus they outlive any order still in flight when the thread gives up waiting
+struct Producer {
+	Exchange*			exchange;
+	Trader*				trader;
+	ExecutionReports*	reports;
+	std::size_t			index;
+	long long			start;			// Time of the first order
+	long long			interval;		// Between two orders, in nanoseconds
+	long long			orders;			// Orders to send
+	std::vector<std::string>	symbols;
+
+	LatencyHistogram	corrected;		// From due time to acknowledgement
+	LatencyHistogram	uncorrected;	// From send time to acknowledgement
+	long long			sent;
+	long long			acknowledged;
+	long long			backpressure;	// Sends retried because an ingress ring was full
+	long long			rejected;
+	long long			lag;			// Longest delay of a send behind its schedule
+	long long			last_ack;		// Time of the last acknowledgement
+	std::uint64_t		dropped;		// Reports lost to a full subscription
+
+	Producer() : exchange(nullptr), trader(nullptr), reports(nullptr), index(0), start(0), interval(0), orders(0), sent(0), acknowledged(0),
+		backpressure(0), rejected(0), lag(0), last_ack(0), dropped(0) {}
+};
+
+// Reads the acknowledgements that arrived. Fills, cancels and rejects end an order
+static void poll(Producer & p, ExecutionReports & reports, IndexTable<std::uint64_t, Pending> & pending) {
+	ExecutionReport report;
+	while (reports.poll(report)) {
+		if (report.type == REPORT_PARTIAL_FILL)
+			continue;
+
+		Pending* order = pending.find(report.order_id);
+		if (order == nullptr)
+			continue;
+
+		p.corrected.record(report.timestamp - order->due);
+		p.uncorrected.record(report.timestamp - order->sent);
+		if (report.timestamp > p.last_ack)
+			p.last_ack = report.timestamp;
+		++p.acknowledged;
+		pending.erase(report.order_id);
+	}
+}
 
-int main() {
-
-	// The Stock Exchange opens! 
-	std::cout << "*** NYSE OPEN ***\n\n";
-	Exchange NYSE;
+// Body of a broker thread: sends on schedule, polls the acknowledgements while it waits
+static void produce(Producer * p) {
+	Trader & trader = *p->trader;
+	ExecutionReports & reports = *p->reports;
+
+	// Requests are only read on submission, thus one per stock and side is reused for every order
+	std::vector<Request*> requests;
+	std::size_t s = 0;
+	for (; s < p->symbols.size(); ++s) {
+		requests.push_back(new AutoRequest("BUY", p->symbols[s], ask_price, 1, "IOC"));
+		requests.push_back(new AutoRequest("SELL", p->symbols[s], bid_price, 1, "IOC"));
+	}
+
+	IndexTable<std::uint64_t, Pending> pending(1 << 16);
+	long long i = 0;
+	for (; i < p->orders; ++i) {
+		Pending order;
+		order.due = p->start + i * p->interval;
+
+		// Wait for the due time, reading acknowledgements meanwhile. Far from it the core
+		// is handed over, thus the producers don't starve the engines of a small box
+		long long now = Clock::now();
+		while (now < order.due) {
+			poll(*p, reports, pending);
+			if (order.due - now > spin_window)
+				std::this_thread::yield();
+			now = Clock::now();
+		}
 
-	// What trades are there to fill?
-	NYSE.print_available_trades();
-	std::cout << "\n\n";
+		// Stocks and sides take turns, thus every engine gets its share of the flow
+		Request* request = requests[(i + p->index) % requests.size()];
+		order.sent = now;
+		if (now - order.due > p->lag)
+			p->lag = now - order.due;
 
-	// Requests to be processed
-	long long N = 1000;
+		SubmitStatus status;
+		while ((status = p->exchange->submit_trade(TradeNode(&trader, request))) == BACKPRESSURE) {
+			++p->backpressure;
+			poll(*p, reports, pending);
+		}
 
-	
-	// 0. Instantiate timer
-	
-		std::chrono::system_clock::time_point start, end;
+		if (status == REJECTED) {
+			++p->rejected;
+			continue;
+		}
+		pending.insert(request->getOrderId(), order);
+		++p->sent;
+	}
+
+	// Wait for the orders still in flight, a few seconds at most
+	long long deadline = Clock::now() + 5000000000LL;
+	while (pending.size() != 0 && Clock::now() < deadline)
+		poll(*p, reports, pending);
+
+	p->dropped = reports.dropped();
+	for (s = 0; s < requests.size(); ++s)
+		delete requests[s];
+}
 
+// Prints a latency histogram in microseconds
+static void print(const char * name, const LatencyHistogram & h) {
+	std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1)
+		<< std::setw(10) << h.percentile(0.50) / 1000.0
+		<< std::setw(10) << h.percentile(0.99) / 1000.0
+		<< std::setw(10) << h.percentile(0.999) / 1000.0
+		<< std::setw(12) << h.max() / 1000.0 << "\n";
+}
 
-	// 1. Create a large BUY and SELL side on the heap
+int main(int argc, char * argv[]) {
 
-		// Create one thousand Traders with BUY requests on the heap
-		std::vector<Trader*> buyers;
-		std::vector<Request*> buy_requests;
-		unsigned i = 0;
-		for (; i < N; ++i) {
-			buyers.push_back(new Trader(100000));
-			buy_requests.push_back(new AutoRequest("BUY", "GOOGL", 1.43, 1));
-		}
+	// 0. Read the settings of the run
 
+		double rate = argc > 1 ? std::atof(argv[1]) : 100000.0;
+		double seconds = argc > 2 ? std::atof(argv[2]) : 2.0;
+		std::size_t producers = argc > 3 ? (std::size_t)std::atoi(argv[3]) : 2;
+		std::size_t engines = argc > 4 ? (std::size_t)std::atoi(argv[4]) : 1;
+		std::string mode = argc > 5 ? argv[5] : "blocking";
 
-		// Create one thousand Traders with SELL requests on the heap
-		std::vector<Trader*> sellers;
-		std::vector<Request*> sell_requests;
-		i = 0;
-		for (; i < N; ++i) {
-			sellers.push_back(new Trader(100000));
-			sell_requests.push_back(new AutoRequest("SELL", "GOOGL", 1.43, 1));
+		if (rate <= 0 || seconds <= 0 || producers == 0 || engines == 0) {
+			std::cerr << "Usage: DEMO2 [rate] [seconds] [producers] [engines] [blocking|spin|rtc]\n";
+			return 1;
 		}
 
-	
-
-	// 2. Create BUY and SELL side thread pools and launch
+		ExchangeConfig config;
+		config.workers = engines;
+		config.wait_strategy = mode == "spin" ? BUSY_SPIN : BLOCKING;
+		config.run_to_completion = mode == "rtc";
 
-		// Create thread pools for requests
-		std::vector<std::thread> buy_request_thread_pool;
-		std::vector<std::thread> sell_request_thread_pool;
+		long long per_producer = (long long)(rate * seconds) / (long long)producers;
+		long long total = per_producer * (long long)producers;
 
-		// Launch BUY and SELL side threads
-		
-		// Start measuring time, since threads are launching upon creation
-		start = std::chrono::system_clock::now();
-
-		i = 0;
-		for (; i < N; ++i) {
-			buy_request_thread_pool.push_back(std::thread(&Exchange::submit_trade, &NYSE, TradeNode(buyers.at(i), buy_requests.at(i))));
-			sell_request_thread_pool.push_back(std::thread(&Exchange::submit_trade, &NYSE, TradeNode(sellers.at(i), sell_requests.at(i))));
-		}
 
+	// 1. The Stock Exchange opens with a deep book on every stock
 
-	
-	// 3. Join all threads to main() and compute elapsed time
+		std::cout << "*** NYSE OPEN ***\n\n";
+		Exchange NYSE(config);
 
-		i = 0;
-		for (; i < N; ++i) {
-			buy_request_thread_pool.at(i).join();
-			sell_request_thread_pool.at(i).join();
+		// One market maker per stock rests enough on both sides to fill every order of the run
+		std::vector<Trader*> makers;
+		std::vector<Request*> quotes;
+		std::size_t s = 0;
+		for (; s < config.symbols.size(); ++s) {
+			makers.push_back(new Trader(1e12, 0));
+			quotes.push_back(new AutoRequest("BUY", config.symbols[s], bid_price, (long)total + 1));
+			quotes.push_back(new AutoRequest("SELL", config.symbols[s], ask_price, (long)total + 1));
+			NYSE.submit_trade(TradeNode(makers[s], quotes[2 * s]));
+			NYSE.submit_trade(TradeNode(makers[s], quotes[2 * s + 1]));
+		}
+		NYSE.flush();
+
+
+	// 2. Launch the producers on a common schedule
+
+		std::vector<Producer> results(producers);
+		std::vector<std::thread> threads;
+
+		// Every producer offers rate / producers orders per second, staggered so that the
+		// orders of all producers together arrive evenly
+		long long interval = (long long)(1e9 * (double)producers / rate);
+		long long start = Clock::now() + 100000000LL;
+
+		std::size_t i = 0;
+		for (; i < producers; ++i) {
+			results[i].exchange = &NYSE;
+			results[i].trader = new Trader(1e12, 0);
+			results[i].reports = new ExecutionReports(1 << 16);
+			results[i].trader->subscribe(results[i].reports);
+			results[i].index = i;
+			results[i].interval = interval;
+			results[i].start = start + (long long)i * interval / (long long)producers;
+			results[i].orders = per_producer;
+			results[i].symbols = config.symbols;
+			threads.push_back(std::thread(produce, &results[i]));
 		}
 
-		// Stop measuring time, since at this time all threads (except main()) have finished execution
-		end = std::chrono::system_clock::now();
 
+	// 3. Join the producers and merge what they measured
+
+		LatencyHistogram corrected, uncorrected;
+		long long sent = 0, acknowledged = 0, backpressure = 0, rejected = 0, lag = 0, last_ack = start;
+		std::uint64_t dropped = 0;
+		for (i = 0; i < producers; ++i) {
+			threads[i].join();
+
+			const Producer & p = results[i];
+			corrected.merge(p.corrected);
+			uncorrected.merge(p.uncorrected);
+			sent += p.sent;
+			acknowledged += p.acknowledged;
+			backpressure += p.backpressure;
+			rejected += p.rejected;
+			dropped += p.dropped;
+			if (p.lag > lag)
+				lag = p.lag;
+			if (p.last_ack > last_ack)
+				last_ack = p.last_ack;
+		}
+		NYSE.flush();
 
-		long long elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
 
-		std::cout << N * 2 << " processed trades. Time Elapsed: " << elapsed_time << " ms\n\n";
+	// 4. Report. The Exchange keeps up as long as the throughput matches the offered
+	//	  rate and the corrected tail stays close to the uncorrected one
 
+		double elapsed = (double)(last_ack - start) / 1e9;
 
-	
-	// 4. Check the number of filled and requested orders
+		std::cout << "Offered: " << std::fixed << std::setprecision(0) << rate << " orders/s for " << std::setprecision(1) << seconds
+			<< " s, " << producers << " producers, " << engines << " engines (" << mode << ")\n";
+		std::cout << "Sent: " << sent << ", acknowledged: " << acknowledged << ", rejected: " << rejected
+			<< ", backpressure retries: " << backpressure << ", reports dropped: " << dropped << "\n";
+		std::cout << "Sustained throughput: " << std::setprecision(0) << (elapsed > 0 ? acknowledged / elapsed : 0.0) << " orders/s\n";
+		std::cout << "Longest send behind schedule: " << std::setprecision(1) << lag / 1000.0 << " us\n\n";
 
-		std::cout << "Total Trade Requests: "	<< NYSE.getOrderBook().size()		<< "\n";
-		std::cout << "Total Filled Trades: "	<< 2 * NYSE.getFillBook().size()	<< "\n\n";	
+		std::cout << std::left << std::setw(24) << "Latency (us)" << std::right
+			<< std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10) << "p99.9" << std::setw(12) << "max" << "\n";
+		print("From schedule", corrected);
+		print("From send", uncorrected);
+		std::cout << "\n";
 
-			// The fill book counts the number of paired requests, that's why we multiply its size by 2 
-			// to get the actual value
+		std::cout << "Fills in the Fill book: " << NYSE.getFillRecords().size() << "\n\n";
 
 
 	// 5. Reclaim memory
 
-		// Free the BUY side
-		i = 0;
-		for (; i < N; ++i) {
-			delete buyers.at(i);
-			delete buy_requests.at(i);
-		}
-
-		// Free the SELL side
-		i = 0;
-		for (; i < N; ++i) {
-			delete sellers.at(i);
-			delete sell_requests.at(i);
+		for (i = 0; i < producers; ++i) {
+			results[i].trader->subscribe(nullptr);
+			delete results[i].trader;
+			delete results[i].reports;
 		}
+		for (s = 0; s < makers.size(); ++s)
+			delete makers[s];
+		for (s = 0; s < quotes.size(); ++s)
+			delete quotes[s];
 
 		// Success!
 
@@ -10,369 +10,495 @@
 
 #include "Exchange.hpp"
 
+#include <sstream>
+
+//*** Helpers shared by the Exchange variants ***//
+
+// Creates the index-th matching engine with the configured ring, wait strategy and pools.
+// Every engine journals its own books to its own segment files, thus appending to
+// a journal never takes a lock: <journal_directory>/engine<index>.<segment>.journal
+MatchingEngine* make_engine(const ExchangeConfig & config, std::size_t index) {
+	Journal* journal = nullptr;
+	if (!config.journal_directory.empty())
+		journal = new Journal(config.journal_directory, "engine" + std::to_string(index), config.journal_segment_size);
+	return new MatchingEngine(config.ring_capacity, config.wait_strategy, config.order_pool_size,
+		config.level_pool_size, config.ladder_levels, journal, config.run_to_completion, config.market_data);
+}
+
+// Tick sizes are whole numbers of minor units. Bad ones fall back to the default
+Cash make_tick_size(const std::string & stock, double tick_size) {
+	Cash ticks = to_cash(tick_size);
+	if (ticks <= 0) {
+		std::cerr << "Bad tick size for " << stock << "! Using $" << to_dollars(default_tick_size) << ".\n";
+		ticks = default_tick_size;
+	}
+	return ticks;
+}
+
+// Rejects are rare, thus the report is built here and not inlined in the submission path
+void report_reject(Trader * trader, std::uint64_t order_id, std::uint64_t request_id, std::uint32_t symbol,
+	const std::string & side, RejectReason reason) {
+	ExecutionReports* reports = trader->subscription();
+	if (reports == nullptr)
+		return;
+
+	ExecutionReport r;
+	r.order_id = order_id;
+	r.request_id = request_id;
+	r.timestamp = Clock::now();
+	r.symbol = symbol;
+	r.side = side == "SELL" ? SIDE_SELL : SIDE_BUY;
+	r.type = REPORT_REJECT;
+	r.reason = reason;
+	reports->push(r);
+}
+
+// Edits and deletes are rarer than submissions, thus they are checked out of line
+bool prepare_edit(ExchangeNode & node, OrderMessage & msg, const std::string & side, double new_price) {
+	RejectReason reason = REJECT_NONE;
+	if (msg.type != OrderMessage::DELETE && node.halted.load(std::memory_order_relaxed))
+		reason = REJECT_HALTED;
+	else if (side != "BUY" && side != "SELL")
+		reason = REJECT_BAD_REQUEST;
+	else if (msg.type == OrderMessage::EDIT_PRICE && (new_price < 0 || !on_tick(new_price, node.tick_size)))
+		reason = REJECT_BAD_REQUEST;
+
+	// The request was never submitted, there is no order to modify
+	else if (msg.order.id == 0)
+		reason = REJECT_UNKNOWN_ORDER;
+
+	if (reason != REJECT_NONE) {
+		report_reject(msg.order.trader, msg.order.id, 0, node.id, side, reason);
+		return false;
+	}
+
+	msg.node = &node;
+	msg.order.side = side == "BUY" ? SIDE_BUY : SIDE_SELL;
+	msg.order.symbol = node.id;
+	if (msg.type == OrderMessage::EDIT_PRICE)
+		msg.order.price = to_ticks(new_price, node.tick_size);
+	return true;
+}
+
 //*** Constructor, Destructor, and Matching Engine methods ***//
 
-// Default constructor opens the Exchange: instantiates the hast table on heap, 
-// initializes a hash function, and starts the matching engine
-Exchange::Exchange() : m_index(0) {
-
-	// The size of the hash table with the ExchangeNodes is the number of 
-	// available stocks at the opening
-	m_size = Stocks.size();
-
-	// Hard-coded hash function. Alternatively we can use std::hash with mod m_size, however
-	// this might create hashing bugs and collisions. Aa good hash function is an entirely different
-	// problem by itself and open to research, thus for the sake of the demo we hard-code a safe
-	// hashing method using a lambda object
-	hash = [&](std::string stock) {
-		if (stock == "GOOGL")
-			return 0;
-		if (stock == "AMZN")
-			return 1;
-		if (stock == "TSLA")
-			return 2;
-		if (stock == "DIS")
-			return 3;
-		if (stock == "BABA")
-			return 4;
-	};
-
-	// Create the hash table (dynamic array)
-	m_exchange = new ExchangeNode[m_size];
-
-	// Flag the engine and launch engine thread
-	exchange_open = true;
+// Default constructor opens the Exchange with the default settings
+Exchange::Exchange() : Exchange(ExchangeConfig()) {}
+
+// Parameter constructor opens the Exchange: lists the stocks in the symbol table, creates
+// their ExchangeNodes on heap, pins every stock to an engine and starts the engines
+Exchange::Exchange(const ExchangeConfig & config) : m_listing(nullptr), m_tick_size(config.tick_size),
+	m_tick_sizes(config.tick_sizes), m_next_order_id(1) {
+
+	// Intern every stock to a dense id: the configured ones first, in order, then the file.
+	// From here on stocks are only known by their id, which indexes the nodes
+	SymbolTable symbols(config.symbols.size());
+	for (const std::string & stock : config.symbols)
+		symbols.intern(stock);
+	if (!config.symbol_file.empty())
+		symbols.load(config.symbol_file);
+
+	// The opening listing. Its size is the number of available stocks at the opening
+	Listing* listing = new Listing(symbols.size());
+	std::uint32_t id = 0;
+	for (; id < (std::uint32_t)symbols.size(); ++id) {
+		listing->symbols.intern(symbols.name(id));
+		listing->nodes[id] = make_node(symbols.name(id), id, 0.0);
+	}
+	listing->size = symbols.size();
+	m_listing.store(listing, std::memory_order_release);
+
+	// Create the engines and pin every stock to exactly one of them
+	m_workers = config.workers == 0 ? 1 : config.workers;
+	m_engines = new MatchingEngine*[m_workers];
+	unsigned i = 0;
+	for (; i < m_workers; ++i)
+		m_engines[i] = make_engine(config, i);
+
+	for (i = 0; i < listing->size; ++i)
+		m_engines[i % m_workers]->pin(listing->nodes[i]);
+
+	// Launch engine threads
 	start_engine();
 }
 
-// Private method that launches the matching engine on the background
-// It runs parallely, letting the brokers/traders to submit requests at all times
+// Private method that launches the matching engines on the background
+// They run parallely, letting the brokers/traders to submit requests at all times
 // This might be a little expensive for the CPU but will certainly payoff for high volumes
 // of incoming requests
 void Exchange::start_engine() {
-	ignite = std::thread{ &Exchange::matching_engine, this };
+	unsigned i = 0;
+	for (; i < m_workers; ++i)
+		m_engines[i]->start();
 }
 
-// Private method that stops the engine. It is called in the destructor
+// Private method that stops the engines. It is called in the destructor
 // and the main thread of execution waits for all requests to be completed
 // before de-allocates the Exchange, thus preventing a crash and memory segmentation
 void Exchange::stop_engine() {
-	ignite.join();
+	unsigned i = 0;
+	for (; i < m_workers; ++i)
+		m_engines[i]->stop();
 }
 
-// Destructor is responsible to stop the matching engine
-// and reclaim the allocated memory
+// Destructor is responsible to stop the matching engines
+// and reclaim the allocated memory. The stocks go first, since their
+// ladders give their entries back to the engines' pools
 Exchange::~Exchange() {
-	exchange_open = false;
 	stop_engine();
-	delete[] m_exchange;
-}
-
-//*** Matching Engine Implementation ***//
-
-// The matching engine will run in the background as long as the
-// exchange is open, and will constantly be checking for available trades
-// anywhere in the exchange. In case we want more matching engines, we can 
-// launch more threads but also install mutex mechanism to the other components
-void Exchange::matching_engine() {
-
-	// While the exchange is open ...
-	while (exchange_open) {
-
-		// ... iterate across the directory ...
-		unsigned i = 0;
-		for (; i < m_size; ++i) {
-
-			// ... and check for each one whether or not there are available trades.
-			if (m_exchange[i].available) {
-
-
-				// If there are trades to be executed ...
-				if (!m_exchange[i].buy_heap.empty() && !m_exchange[i].sell_heap.empty()) {
-
-					// ... check the prices of SELL and BUY orders to see if the trade is possible.
-					TradeNode buy_order = m_exchange[i].buy_heap[0];
-					TradeNode sell_order = m_exchange[i].sell_heap[0];
 
-					double buy_price = buy_order.request->getPrice();
-					double sell_price = sell_order.request->getPrice();
+	// The current listing holds every node ever listed
+	Listing* listing = m_listing.load(std::memory_order_acquire);
+	std::size_t n = 0;
+	for (; n < listing->size; ++n)
+		delete listing->nodes[n];
+	delete listing;
+	for (Listing * retired : m_retired)
+		delete retired;
 
-					if (buy_price < sell_price)
-						continue;
-
-					double trade_price = 0.0;
-
-					if (buy_price > sell_price)
-						if (buy_order.submit_id < sell_order.submit_id)
-							trade_price = buy_price;
-						else
-							trade_price = sell_price;
-					
+	unsigned i = 0;
+	for (; i < m_workers; ++i)
+		delete m_engines[i];
+	delete[] m_engines;
+}
 
-					// Get quantities
-					long buy_quant = buy_order.request->getQuantity();
-					long sell_quant = sell_order.request->getQuantity();
+// Creates the node of a stock. A tick size of 0 falls back to the configured ones
+ExchangeNode* Exchange::make_node(const std::string & stock, std::uint32_t id, double tick_size) {
+	if (tick_size == 0.0) {
+		auto custom = m_tick_sizes.find(stock);
+		tick_size = custom != m_tick_sizes.end() ? custom->second : m_tick_size;
+	}
 
-					bool buy_status;
-					bool sell_status;
+	ExchangeNode* node = new ExchangeNode;
+	node->stock = stock;
+	node->id = id;
+	node->tick_size = make_tick_size(stock, tick_size);
+	return node;
+}
 
-					// If demand meets supply or when buyer wants more
-					if (buy_quant >= sell_quant) {
+//*** Auxiliary Methods for a Stock Exchange ***//
 
-						// Attempt to perform the trade
-						buy_status = buy_order.trader->buy(trade_price, sell_quant);
-						sell_status = sell_order.trader->sell(trade_price, sell_quant);
+// Method that waits for every engine to apply the messages already in its ring
+void Exchange::flush() {
+	unsigned i = 0;
+	for (; i < m_workers; ++i)
+		m_engines[i]->flush();
+}
 
-						// Reimburse the trader if the other doesn't fall through
-						if (buy_status == true && sell_status == false)
-							buy_order.trader->reimburse(trade_price * (double)sell_quant);
+// Method that prints all available trades 
+void Exchange::print_available_trades() {
+	const Listing* listing = m_listing.load(std::memory_order_acquire);
+	std::size_t i = 0;
+	bool no_trades = true;
+	for (; i < listing->size; ++i)
+		if (listing->nodes[i]->available.load(std::memory_order_relaxed)) {
+			std::cout << "Available: " << listing->nodes[i]->stock << "\n";
+			no_trades = false;
+		}
+	if (no_trades)
+		std::cout << "No trades to fill!";
+}
 
-						if (buy_status == false && sell_status == true)
-							sell_order.trader->reimburse(trade_price * (double)sell_quant);
+// Getter method that returns the order book records. Every engine keeps the
+// records of its own stocks, thus the books are gathered engine by engine
+const std::vector<OrderRecord> Exchange::getOrderRecords() {
+	std::vector<OrderRecord> book;
+	unsigned i = 0;
+	for (; i < m_workers; ++i)
+		m_engines[i]->collectOrderBook(book);
+	return book;
+}
 
-						// If trade is executed successfully
-						if (buy_status && sell_status) {
+// Getter method that returns the fill book records
+const std::vector<FillRecord> Exchange::getFillRecords() {
+	std::vector<FillRecord> book;
+	unsigned i = 0;
+	for (; i < m_workers; ++i)
+		m_engines[i]->collectFillBook(book);
+	return book;
+}
 
-							// Remove the trades
-							auto buyer = m_exchange[i].buy_heap[0];
-							buyer.request->setQuantity(buy_quant - sell_quant);
+// Getter methods for the market data of a stock. The node is found in the current
+// listing and its snapshot is copied out of the engine's SeqLock, thus no lock is taken
+bool Exchange::get_quote(const std::string & stock, Quote & quote) {
+	const Listing* listing = m_listing.load(std::memory_order_acquire);
+	std::uint32_t index = listing->symbols.find(stock);
+	if (index == SymbolTable::npos)
+		return false;
 
-							if (buyer.request->getQuantity() == 0)
-								m_exchange[i].buy_heap.pop();
+	quote = listing->nodes[index]->quote.read();
+	return true;
+}
 
-							auto seller = m_exchange[i].sell_heap.pop();
+bool Exchange::get_depth(const std::string & stock, BookDepth & depth) {
+	const Listing* listing = m_listing.load(std::memory_order_acquire);
+	std::uint32_t index = listing->symbols.find(stock);
+	if (index == SymbolTable::npos)
+		return false;
 
-							// Update the Fill book
-							std::stringstream ss;
-							auto rd1 = buyer.request->getData();
-							auto rd2 = seller.request->getData();
+	depth = listing->nodes[index]->depth.read();
+	return true;
+}
 
-							ss << "* Trader: " << buyer.trader->getId() << "\nORDER: " << std::get<0>(rd1)
-								<< ", " << std::get<1>(rd1) << ", $" << trade_price
-								<< ", " << std::get<3>(rd1) << ", " << std::get<4>(rd1)
-								<< "\n* Trader: " << seller.trader->getId() << "\nORDER: " << std::get<0>(rd2)
-								<< ", " << std::get<1>(rd2) << ", $" << trade_price
-								<< ", " << std::get<3>(rd2) << ", " << std::get<4>(rd2);
-							FillBook.push_back(ss.str());
+// Adds up the usage of one kind of pool over the engines
+static void add_stats(PoolStats & total, const PoolStats & engine) {
+	total.capacity += engine.capacity;
+	total.in_use += engine.in_use;
+	total.peak += engine.peak;
+	total.slabs += engine.slabs;
+}
 
-							// Update ExchangeNode as per the availability there
-							if (m_exchange[i].buy_heap.empty() && m_exchange[i].sell_heap.empty())
-								m_exchange[i].available = false;
-						}
-					}
+// Getter method for the usage of the resting order pools
+const PoolStats Exchange::getOrderPoolStats() {
+	PoolStats total;
+	unsigned i = 0;
+	for (; i < m_workers; ++i)
+		add_stats(total, m_engines[i]->orderPoolStats());
+	return total;
+}
 
-					// If seller wants more
-					if (buy_quant < sell_quant) {
+// Getter method for the usage of the price level pools
+const PoolStats Exchange::getLevelPoolStats() {
+	PoolStats total;
+	unsigned i = 0;
+	for (; i < m_workers; ++i)
+		add_stats(total, m_engines[i]->levelPoolStats());
+	return total;
+}
 
-						// Attempt to perform the trade
-						buy_status = buy_order.trader->buy(trade_price, buy_quant);
-						sell_status = sell_order.trader->sell(trade_price, buy_quant);
+// Getter method that returns the order book as text. The records are
+// formatted here, away from the submission and matching paths
+const std::vector<std::string> Exchange::getOrderBook() {
+	std::vector<std::string> book;
+	for (const OrderRecord & record : getOrderRecords())
+		book.push_back(format(record));
+	return book;
+}
 
-						// Reimburse the trader if the other doesn't fall through
-						if (buy_status == true && sell_status == false)
-							buy_order.trader->reimburse(trade_price * (double)buy_quant);
+// Getter method for the Fill book that holds all successfully executed orders, as text
+const std::vector<std::string> Exchange::getFillBook() {
+	std::vector<std::string> book;
+	for (const FillRecord & record : getFillRecords())
+		book.push_back(format(record));
+	return book;
+}
 
-						if (buy_status == false && sell_status == true)
-							sell_order.trader->reimburse(trade_price * (double)buy_quant);
+// Order types as printed after the side. Limit orders print the side alone
+static const char * order_type_names[] = { "", " IOC", " FOK", " MARKET" };
 
-						// If trade is executed successfully
-						if (buy_status && sell_status) {
+// Formats an Order book record
+const std::string Exchange::format(const OrderRecord & record) {
+	const ExchangeNode* node = m_listing.load(std::memory_order_acquire)->nodes[record.symbol];
+	std::stringstream ss;
+	ss	<< "Trader: "	<< record.trader_id		<< "\nORDER: "	<< (record.side == SIDE_BUY ? "BUY" : "SELL")
+		<< order_type_names[record.type]
+		<< ", "			<< node->stock		<< ", "	<< to_price(record.price, node->tick_size)
+		<< ", "			<< record.quantity		<< ", "	<< Clock::format(record.timestamp);
+	return ss.str();
+}
 
-							// Remove the trades
-							auto buyer = m_exchange[i].buy_heap.pop();
-							auto seller = m_exchange[i].sell_heap[0];
-							seller.request->setQuantity(sell_quant - buy_quant);
+// Formats a Fill book record
+const std::string Exchange::format(const FillRecord & record) {
+	const ExchangeNode* node = m_listing.load(std::memory_order_acquire)->nodes[record.symbol];
+	std::stringstream ss;
+	double price = to_price(record.price, node->tick_size);
+	std::string timestamp = Clock::format(record.timestamp);
+	ss << "* Trader: " << record.buyer_id << "\nORDER: BUY, " << node->stock
+		<< ", $" << price << ", " << record.quantity << ", " << timestamp;
+	ss << "\n* Trader: " << record.seller_id << "\nORDER: SELL, " << node->stock
+		<< ", $" << price << ", " << record.quantity << ", " << timestamp;
+	return ss.str();
+}
 
-							if (seller.request->getQuantity() == 0)
-								m_exchange[i].sell_heap.pop();
+//*** Modifiers ***//
 
-							// Update the Fill book
-							std::stringstream ss;
-							auto rd1 = buyer.request->getData();
-							auto rd2 = seller.request->getData();
-
-							ss << "* Trader: " << buyer.trader->getId() << "\nORDER: " << std::get<0>(rd1)
-								<< ", " << std::get<1>(rd1) << ", $" << trade_price
-								<< ", " << std::get<3>(rd1) << ", " << std::get<4>(rd1)
-								<< "\n* Trader: " << seller.trader->getId() << "\nORDER: " << std::get<0>(rd2)
-								<< ", " << std::get<1>(rd2) << ", $" << trade_price
-								<< ", " << std::get<3>(rd2) << ", " << std::get<4>(rd2);
-							FillBook.push_back(ss.str());
-
-							// Update ExchangeNode as per the availability there
-							if (m_exchange[i].buy_heap.empty() && m_exchange[i].sell_heap.empty())
-								m_exchange[i].available = false;
-						}
-					}
-				}
-			}
-		}
+// Validates the stock and side of an edit or delete, and routes the message
+// to the ingress ring of the engine that owns the stock. A halted stock only takes deletes.
+// Rejects are reported to the trader
+SubmitStatus Exchange::modify(OrderMessage & msg, const std::string & side, const std::string & instrument, double new_price) {
+	const Listing* listing = m_listing.load(std::memory_order_acquire);
+	std::uint32_t i = listing->symbols.find(instrument);
+	if (i == SymbolTable::npos) {
+		report_reject(msg.order.trader, msg.order.id, 0, i, side, REJECT_UNKNOWN_STOCK);
+		return REJECTED;
 	}
+
+	if (!prepare_edit(*listing->nodes[i], msg, side, new_price))
+		return REJECTED;
+	return m_engines[i % m_workers]->enqueue(msg);
 }
 
-//*** Auxiliary Methods for a Stock Exchange ***//
+// Edits and deletes address the Order the Exchange made from the request on submission.
+// The Request itself is the client's ticket and is not modified by the Exchange
 
-// Method that prints all available trades 
-void Exchange::print_available_trades() {
-	unsigned i = 0;
-	bool no_trades = true;
-	for (; i < m_size; ++i)
-		if (m_exchange[i].available) {
-			std::cout << "Available: " << m_exchange[i].stock << "\n";
-			no_trades = false;
-		}
-	if (no_trades)
-		std::cout << "No trades to fill!";
+// Editing an existing trade -- change the price
+SubmitStatus Exchange::edit_trade_price(Trader * t, Request * r, std::string side, std::string instrument, double new_price) {
+	OrderMessage msg;
+	msg.type = OrderMessage::EDIT_PRICE;
+	msg.order.id = r->getOrderId();
+	msg.order.trader = t;
+	return modify(msg, side, instrument, new_price);
 }
 
-// Getter method that returns the order book
-const std::vector<std::string> Exchange::getOrderBook() {
-	return OrderBook;
+// Editing an existing trade -- change the quantity
+SubmitStatus Exchange::edit_trade_quantity(Trader * t, Request * r, std::string side, std::string instrument, long new_quantity) {
+	OrderMessage msg;
+	msg.type = OrderMessage::EDIT_QUANTITY;
+	msg.order.id = r->getOrderId();
+	msg.order.trader = t;
+	msg.order.quantity = new_quantity;
+	return modify(msg, side, instrument);
 }
 
-// Wrapper method to update the order book. Converts all request 
-// input to a string upon successful submission
-void Exchange::updateOrderBook(TradeNode & tn) {
-
-	std::stringstream ss;
-	auto rd = tn.request->getData();
-
-	// Convert to string
-	ss	<< "Trader: "	<< tn.trader->getId()	<< "\nORDER: "	<< std::get<0>(rd)
-		<< ", "			<< std::get<1>(rd)		<< ", "			<< std::get<2>(rd)
-		<< ", "			<< std::get<3>(rd)		<< ", "			<< std::get<4>(rd);
-
-	// Submit to the book
-	OrderBook.push_back(ss.str());
+// Deleting an existing trade
+SubmitStatus Exchange::delete_trade(Trader * t, Request * r, std::string side, std::string instrument) {
+	OrderMessage msg;
+	msg.type = OrderMessage::DELETE;
+	msg.order.id = r->getOrderId();
+	msg.order.trader = t;
+	return modify(msg, side, instrument);
 }
 
-// Getter method for the Fill book that holds all successfully executed orders
-const std::vector<std::string> Exchange::getFillBook() {
-	return FillBook;
-}
+//*** Batch submission ***//
+
+// Submits a burst of trades. The messages are grouped by engine with a counting sort,
+// which keeps the order of the trades of every stock. The buffers belong to the calling
+// thread and keep their capacity from one batch to the next, thus a steady flow of
+// batches doesn't allocate
+std::size_t Exchange::submit_trades(const TradeNode * trades, std::size_t count, SubmitStatus * status) {
+	thread_local std::vector<OrderMessage> msgs;		// Valid trades, in the order of the input
+	thread_local std::vector<std::size_t> origin;		// Input index of every message
+	thread_local std::vector<OrderMessage> grouped;		// Messages grouped by engine
+	thread_local std::vector<std::size_t> grouped_origin;
+	thread_local std::vector<std::size_t> first;		// First message of every engine in grouped
+
+	msgs.resize(count);
+	origin.resize(count);
+
+	// Validate every trade against the same listing
+	const Listing* listing = m_listing.load(std::memory_order_acquire);
+	std::size_t valid = 0, i = 0;
+	for (; i < count; ++i) {
+		if (prepare(listing, trades[i], msgs[valid])) {
+			origin[valid] = i;
+			++valid;
+		}
+		else if (status != nullptr)
+			status[i] = REJECTED;
+	}
 
-//*** Modifiers ***//
+	// One reservation of order ids for the batch
+	std::uint64_t id = m_next_order_id.fetch_add(valid, std::memory_order_relaxed);
 
-// Editing an existing trade -- change the price
-void Exchange::edit_trade_price(Trader * t, Request * r, std::string side, std::string instrument, double new_price) {
-	unsigned i = hash(instrument);
-	if (!(i >= 0 && i <= 4))
-		return;
+	first.assign(m_workers + 1, 0);
+	for (i = 0; i < valid; ++i) {
+		msgs[i].order.id = id + i;
+		trades[origin[i]].request->setOrderId(id + i);
+		++first[msgs[i].node->id % m_workers + 1];
+	}
+	for (i = 0; i < m_workers; ++i)
+		first[i + 1] += first[i];
+
+	grouped.resize(valid);
+	grouped_origin.resize(valid);
+	for (i = 0; i < valid; ++i) {
+		std::size_t slot = first[msgs[i].node->id % m_workers]++;
+		grouped[slot] = msgs[i];
+		grouped_origin[slot] = origin[i];
+	}
 
-	if (side == "BUY") {
-		unsigned j = 0;
-		while (j < m_exchange[i].buy_heap.size()) {
-			if (t->getId() == m_exchange[i].buy_heap[j].trader->getId() && r->getId() == m_exchange[i].buy_heap[j].request->getId()) {
-				m_exchange[i].buy_heap[j].request->setPrice(new_price);
-				m_exchange[i].buy_heap.sort();
-				return;
+	// first[e] now ends the messages of engine e, hand every engine its part at once
+	std::size_t submitted = 0, begin = 0, e = 0;
+	for (; e < m_workers; ++e) {
+		std::size_t end = first[e];
+		std::size_t pushed = begin < end ? m_engines[e]->enqueue(&grouped[begin], end - begin) : 0;
+		submitted += pushed;
+
+		for (i = begin; i < end; ++i) {
+			if (i < begin + pushed) {
+				if (status != nullptr)
+					status[grouped_origin[i]] = SUBMITTED;
 			}
-			++j;
-		}
-		if (j == m_exchange[i].buy_heap.size())
-			return;
-	}
-	
-
-	if (side == "SELL") {
-		unsigned j = 0;
-		while (j < m_exchange[i].sell_heap.size()) {
-			if (t->getId() == m_exchange[i].sell_heap[j].trader->getId() && r->getId() == m_exchange[i].sell_heap[j].request->getId()) {
-				m_exchange[i].sell_heap[j].request->setPrice(new_price);
-				m_exchange[i].sell_heap.sort();
-				return;
+			else {
+				const Order & order = grouped[i].order;
+				order.trader->release(reservation(order, grouped[i].node->tick_size, order.quantity));
+				trades[grouped_origin[i]].request->setOrderId(0);
+				if (status != nullptr)
+					status[grouped_origin[i]] = BACKPRESSURE;
 			}
-			++j;
 		}
-		if (j == m_exchange[i].sell_heap.size())
-			return;
+		begin = end;
 	}
-	return;
+	return submitted;
 }
 
-// Editing an existing trade -- change the quantity
-void Exchange::edit_trade_quantity(Trader * t, Request * r, std::string side, std::string instrument, long new_quantity) {
-	unsigned i = hash(instrument);
-	if (!(i >= 0 && i <= 4))
-		return;
+std::size_t Exchange::submit_trades(const std::vector<TradeNode> & trades, SubmitStatus * status) {
+	return trades.empty() ? 0 : submit_trades(trades.data(), trades.size(), status);
+}
 
-	if (side == "BUY") {
-		unsigned j = 0;
-		while (j < m_exchange[i].buy_heap.size()) {
-			if (t->getId() == m_exchange[i].buy_heap[j].trader->getId() && r->getId() == m_exchange[i].buy_heap[j].request->getId()) {
-				if (new_quantity < m_exchange[i].buy_heap[j].request->getQuantity()) {
-					m_exchange[i].buy_heap[j].request->setQuantity(new_quantity);
-					m_exchange[i].buy_heap.sort();
-					return;
-				} 
-				else {
-					m_exchange[i].buy_heap[j].request->setQuantity(new_quantity);
-					return;
-				}
-			}
-			++j;
-		}
-		if (j == m_exchange[i].buy_heap.size())
-			return;
+//*** Intraday listing ***//
+
+// Lists a stock while the brokers and the engines keep running (read-copy-update):
+//	1) a new listing is built next to the current one, with the new stock appended,
+//	2) the engine of the stock gets a LIST message and sets the ladders up on its own thread,
+//	3) the new listing is published with one atomic store.
+// A broker that sees the new listing enqueues after the LIST message, thus the engine
+// always knows the stock before its first request. The old listing is retired, not freed,
+// since brokers may still be reading it
+SubmitStatus Exchange::add_instrument(const std::string & stock, double tick_size) {
+	if (stock.empty())
+		return REJECTED;
+
+	std::unique_lock<std::mutex> lock(m_listing_mt);
+	Listing* current = m_listing.load(std::memory_order_relaxed);
+	if (current->symbols.find(stock) != SymbolTable::npos)
+		return REJECTED;
+
+	// Copy. The ids of the listed stocks don't change
+	Listing* next = new Listing(current->size + 1);
+	std::size_t i = 0;
+	for (; i < current->size; ++i) {
+		next->symbols.intern(current->symbols.name((std::uint32_t)i));
+		next->nodes[i] = current->nodes[i];
 	}
 
+	// Update
+	std::uint32_t id = next->symbols.intern(stock);
+	next->nodes[id] = make_node(stock, id, tick_size);
+	next->size = current->size + 1;
 
-	if (side == "SELL") {
-		unsigned j = 0;
-		while (j < m_exchange[i].sell_heap.size()) {
-			if (t->getId() == m_exchange[i].sell_heap[j].trader->getId() && r->getId() == m_exchange[i].sell_heap[j].request->getId()) {
-				if (new_quantity < m_exchange[i].sell_heap[j].request->getQuantity()) {
-					m_exchange[i].sell_heap[j].request->setQuantity(new_quantity);
-					m_exchange[i].sell_heap.sort();
-					return;
-				}
-				else {
-					m_exchange[i].sell_heap[j].request->setQuantity(new_quantity);
-					return;
-				}
-			}
-			++j;
-		}
-		if (j == m_exchange[i].sell_heap.size())
-			return;
-	}
-	return;
-}
+	OrderMessage msg;
+	msg.type = OrderMessage::LIST;
+	msg.node = next->nodes[id];
+	send(msg);
 
-// Deleting an existing trade
-void Exchange::delete_trade(Trader * t, Request * r, std::string side, std::string instrument) {
-	unsigned i = hash(instrument);
-	if (!(i >= 0 && i <= 4))
-		return;
+	// Publish
+	m_listing.store(next, std::memory_order_release);
+	m_retired.push_back(current);
+	return SUBMITTED;
+}
 
-	if (side == "BUY") {
-		unsigned j = 0;
-		while (j < m_exchange[i].buy_heap.size()) {
-			if (t->getId() == m_exchange[i].buy_heap[j].trader->getId() && r->getId() == m_exchange[i].buy_heap[j].request->getId()) {
-				m_exchange[i].buy_heap.remove(t, r);
-				if (m_exchange[i].buy_heap.empty() && m_exchange[i].sell_heap.empty())
-					m_exchange[i].available = false;
-				return;
-			}
-			++j;
-		}
-		if (j == m_exchange[i].buy_heap.size())
-			return;
-	}
+// Halts a stock. The flag stops new requests at the door right away, and the HALT
+// message stops matching and empties the book once the engine has applied what was
+// already in its ring
+SubmitStatus Exchange::halt_instrument(const std::string & stock) {
+	std::unique_lock<std::mutex> lock(m_listing_mt);
+	const Listing* listing = m_listing.load(std::memory_order_relaxed);
+	std::uint32_t id = listing->symbols.find(stock);
+	if (id == SymbolTable::npos || listing->nodes[id]->halted.exchange(true))
+		return REJECTED;
+
+	OrderMessage msg;
+	msg.type = OrderMessage::HALT;
+	msg.node = listing->nodes[id];
+	send(msg);
+	return SUBMITTED;
+}
 
-	if (side == "SELL") {
-		unsigned j = 0;
-		while (j < m_exchange[i].sell_heap.size()) {
-			if (t->getId() == m_exchange[i].sell_heap[j].trader->getId() && r->getId() == m_exchange[i].sell_heap[j].request->getId()) {
-				m_exchange[i].sell_heap.remove(t, r);
-				if (m_exchange[i].buy_heap.empty() && m_exchange[i].sell_heap.empty())
-					m_exchange[i].available = false;
-				return;
-			}
-			++j;
-		}
-		if (j == m_exchange[i].sell_heap.size())
-			return;
-	}
-	return;
+// Listing and halt messages wait for room in the ring. They are rare, and
+// the engine keeps draining while the caller yields
+void Exchange::send(const OrderMessage & msg) {
+	MatchingEngine* engine = m_engines[msg.node->id % m_workers];
+	while (engine->enqueue(msg) == BACKPRESSURE)
+		std::this_thread::yield();
 }
@@ -18,28 +18,133 @@
 #include <iostream>
 #include <string>
 #include <map>
-#include <set>
+#include <vector>
 #include <mutex>
-#include <condition_variable>
-#include <functional>	
-#include <thread>
-
-#include "TradeHeap.hpp"
-
-//*** ExchangeNode data structure ***//
-
-// This is a data structure that models a particular equity in the stock market
-// Every trading requests that refer to a stock will be handled by the ExchangeNode
-// of that stock. It consists of the stock name, an availability indicator that holds 
-// true when there is at least one available trade there, and two TradeHeap objects
-// whose purpose is to sort and handle all requests appropriately. 
-struct ExchangeNode {
-	std::string		stock;
-	TradeHeap		buy_heap;		// Buy requests will be stored here
-	TradeHeap		sell_heap;		// Sell requests will be stored here
-	bool			available;
-
-	ExchangeNode() : available(false), stock("") {}
+#include <atomic>
+
+#include "TradeHeap.hpp"		// TradeNode: Trader and Request, the front end of a submission
+#include "MatchingEngine.hpp"
+#include "SymbolTable.hpp"
+
+//*** ExchangeConfig data structure ***//
+
+// Settings of an Exchange that are fixed at the opening
+struct ExchangeConfig {
+	std::size_t		workers;		// Number of matching engines (threads)
+	std::size_t		ring_capacity;	// Slots of each engine's ingress ring
+	WaitStrategy	wait_strategy;	// What idle engines do (see MatchingEngine.hpp)
+	bool			run_to_completion;		// Brokers match on their own thread, engines start no thread
+	std::vector<std::string>	symbols;	// Listed stocks. Their ids follow this order
+	std::string		symbol_file;			// File with more stocks, one per line. Empty: none
+	std::string		journal_directory;		// Where engines journal their books. Empty: no journal
+	std::size_t		journal_segment_size;	// Size of every journal segment file, in bytes
+	double			tick_size;				// Tick size of the stocks, in dollars
+	std::map<std::string, double>	tick_sizes;	// Stocks with their own tick size, in dollars
+	std::size_t		order_pool_size;		// Resting orders each engine holds without allocating
+	std::size_t		level_pool_size;		// Price levels each engine holds without allocating
+	std::size_t		ladder_levels;			// Price levels each side of a stock indexes upfront. A busier side doubles its index
+	bool			market_data;			// Engines publish the quotes and the depth of their stocks
+
+	ExchangeConfig() : workers(1), ring_capacity(1 << 16), wait_strategy(BLOCKING), run_to_completion(false),
+		symbols({ "GOOGL", "AMZN", "TSLA", "DIS", "BABA" }), symbol_file(""), journal_directory(""), journal_segment_size(64 << 20),
+		tick_size(0.01), order_pool_size(1 << 16), level_pool_size(1 << 12), ladder_levels(16), market_data(true) {}
+};
+
+//*** Helpers shared by the Exchange variants ***//
+
+// Creates the index-th matching engine of an Exchange, with its journal if configured
+MatchingEngine* make_engine(const ExchangeConfig & config, std::size_t index);
+
+// Converts a tick size in dollars to minor units. A bad one falls back to the default
+Cash make_tick_size(const std::string & stock, double tick_size);
+
+// Reports a request turned away at the door to its trader, if subscribed. A rejected
+// submission has no order id yet and is identified by its request id
+void report_reject(Trader * trader, std::uint64_t order_id, std::uint64_t request_id, std::uint32_t symbol,
+	const std::string & side, RejectReason reason);
+
+// Validates a submission for a listed stock and builds its message, without an order id.
+// The request enters the exchange here: from now on it is a compact Order with an
+// integer price in ticks, and the engines never call back into the Request.
+// Reserves the notional of the order out of the trader's buying power.
+// Returns false, and reports the reject to the trader, if the stock is halted, the side,
+// the type, the price or the quantity is wrong, or the trader can't cover the order.
+// Every Exchange variant finds the node its own way, then submits through here
+inline bool prepare_order(ExchangeNode & node, const TradeNode & tn, OrderMessage & msg) {
+
+	// Get the trading side
+	std::string side = tn.request->getSide();
+
+	if (node.halted.load(std::memory_order_relaxed)) {
+		std::cerr << "Bad trade request! Stock is halted.\n";
+		report_reject(tn.trader, 0, tn.request->getId(), node.id, side, REJECT_HALTED);
+		return false;
+	}
+
+	if (side != "BUY" && side != "SELL") {
+		report_reject(tn.trader, 0, tn.request->getId(), node.id, side, REJECT_BAD_REQUEST);
+		return false;
+	}
+
+	// Get the order type. A typo must not turn into a resting limit order
+	std::string type = tn.request->getType();
+	if (type != "LIMIT" && type != "IOC" && type != "FOK" && type != "MARKET") {
+		std::cerr << "Bad trade request! Unknown order type.\n";
+		report_reject(tn.trader, 0, tn.request->getId(), node.id, side, REJECT_BAD_REQUEST);
+		return false;
+	}
+
+	// Limits must be on the tick grid, a rounded one could trade through the client's price
+	if (type != "MARKET" && !on_tick(tn.request->getPrice(), node.tick_size)) {
+		std::cerr << "Bad trade request! Price is not a whole number of ticks.\n";
+		report_reject(tn.trader, 0, tn.request->getId(), node.id, side, REJECT_BAD_REQUEST);
+		return false;
+	}
+
+	msg.type = OrderMessage::SUBMIT;
+	msg.node = &node;
+	msg.order = tn.request->toOrder(node.id, node.tick_size);
+	msg.order.trader = tn.trader;
+	msg.order.submitted = Clock::now();
+	if (msg.order.quantity <= 0 || msg.order.price < 0) {
+		report_reject(tn.trader, 0, tn.request->getId(), node.id, side, REJECT_BAD_REQUEST);
+		return false;
+	}
+
+	// Pre-trade credit check: the notional is reserved now, thus the fills settle for sure
+	if (!tn.trader->reserve(reservation(msg.order, node.tick_size, msg.order.quantity))) {
+		std::cerr << "Bad trade request! Trader with id: " << tn.trader->getId() << " cannot cover it.\n";
+		report_reject(tn.trader, 0, tn.request->getId(), node.id, side, REJECT_CREDIT);
+		return false;
+	}
+	return true;
+}
+
+// Validates an edit or delete of an order resting on a listed stock and completes its
+// message: the node, the side, the stock and, for EDIT_PRICE, the new price in ticks.
+// A halted stock only takes deletes. Returns false, and reports the reject to the
+// trader, if the stock is halted, the side or the new price is wrong, or the request
+// was never submitted
+bool prepare_edit(ExchangeNode & node, OrderMessage & msg, const std::string & side, double new_price);
+
+//*** Listing data structure ***//
+
+// Snapshot of the listed stocks: the symbol table and the node of every id.
+// A listing is never modified once it is published. Listing a stock intraday builds
+// a new listing and publishes it with one atomic store (read-copy-update), thus brokers
+// read the stocks without a lock while the listing changes under them.
+// The nodes belong to the Exchange and are shared by all the listings
+struct Listing {
+	SymbolTable		symbols;
+	ExchangeNode**	nodes;		// Id -> node
+	std::size_t		size;		// Number of listed stocks
+
+	Listing(std::size_t capacity) : symbols(capacity), nodes(new ExchangeNode*[capacity]), size(0) {}
+	~Listing() { delete[] nodes; }
+
+private:
+	Listing(const Listing &);
+	Listing& operator=(const Listing &);
 };
 
 //*** Exchange class ***//
@@ -55,6 +160,12 @@ struct ExchangeNode {
 // submission is required, thus we are using STL's mutual exclusion mechanisms and condition variables.
 // Additionally, all the matching engine methods are encapsulated (declared private) as its only
 // the Exchange's responsibility to execute requests. In a case of a dark pool, that might not hold.
+// The Exchange runs one or more matching engines. Every stock is pinned to exactly one engine
+// and every request is routed to the engine of its stock through a lock-free ingress ring,
+// thus brokers never serialize on a mutex and flow spread across stocks is matched on as many
+// cores as there are engines.
+// Stocks can be listed (IPOs) and halted while the Exchange trades. Neither stops the
+// brokers or the engines: see add_instrument and halt_instrument.
 class Exchange {
 public:
 
@@ -63,109 +174,147 @@ public:
 	// number of total Stocks is variable
 	Exchange();
 
-	// closes the Ctock Exchange and waits for the matching engine to finish execution
+	// Parameter constructor opens the Exchange with the given settings. Every stock
+	// is pinned to one of config.workers matching engines
+	Exchange(const ExchangeConfig & config);
+
+	// closes the Ctock Exchange and waits for the matching engines to finish execution
 	// Then it reclaims memory
 	~Exchange();
 
-	// Iterates the hash table and prints all available trade information
+	// Waits until every request submitted, edited or deleted before the call has been
+	// applied by the matching engines. The ingress is asynchronous, thus callers that
+	// want to observe the books or the trader accounts right away call it first
+	void flush();
+
+	// Iterates the stocks and prints all available trade information
 	void print_available_trades();
 
-	// Returns the Order book
+	// Returns the Order book, formatted as text
 	const std::vector<std::string> getOrderBook();
 
-	// Returns the Fill book
+	// Returns the Fill book, formatted as text
 	const std::vector<std::string> getFillBook();
 
+	// Return the raw Order and Fill book records. Nothing is formatted
+	const std::vector<OrderRecord> getOrderRecords();
+	const std::vector<FillRecord> getFillRecords();
+
+	// Format a single record as text, the way the books print it
+	const std::string format(const OrderRecord & record);
+	const std::string format(const FillRecord & record);
+
+	// Market data of a stock: its best bid and offer, or its top book_depth levels per side,
+	// as last published by its engine. Lock-free, thus any number of threads can poll them
+	// while the Exchange trades. Returns false if the stock is not listed
+	bool get_quote(const std::string & stock, Quote & quote);
+	bool get_depth(const std::string & stock, BookDepth & depth);
+
+	// Usage of the resting order and price level pools, summed over the engines
+	const PoolStats getOrderPoolStats();
+	const PoolStats getLevelPoolStats();
+
+	// Lists a new stock while the Exchange trades. A tick size of 0 means the configured one.
+	// The stock gets the next id and is pinned to an engine, which sets up its ladders before
+	// any request for it; then the new listing is published and brokers can trade it.
+	// Returns REJECTED if the stock is already listed
+	SubmitStatus add_instrument(const std::string & stock, double tick_size = 0.0);
+
+	// Halts a stock. New requests and edits are rejected from now on, deletes still go
+	// through. The engine applies the halt after the messages already in its ring, fills
+	// what they cross, then cancels the resting orders and releases their reservations.
+	// Returns REJECTED if the stock is not listed or already halted
+	SubmitStatus halt_instrument(const std::string & stock);
+
 	// Edit trade
-	void edit_trade_price(Trader * t, Request * r, std::string side, std::string instrument, double new_price);
-	void edit_trade_quantity(Trader * t, Request * r, std::string side, std::string instrument, long quantity);
+	SubmitStatus edit_trade_price(Trader * t, Request * r, std::string side, std::string instrument, double new_price);
+	SubmitStatus edit_trade_quantity(Trader * t, Request * r, std::string side, std::string instrument, long quantity);
 
 	// Delete trade
-	void delete_trade(Trader * t, Request * r, std::string side, std::string instrument);
+	SubmitStatus delete_trade(Trader * t, Request * r, std::string side, std::string instrument);
 
-	// Submit trade method. This method takes a TradeNode object reference cause
+	// Submit trade method. This method takes a TradeNode object cause
 	// we want the traders' accounts to be updated after a trade is executed by the matchine engine.
-	// It implements elementary mutex mechanisms to hedge against multiple requests, 
-	// and logs every successful trade request to the Order Book.
+	// The request is validated here and enqueued in the lock-free ingress ring of the engine
+	// that owns the stock, thus no broker ever waits for a lock or for another broker.
+	// The matching engine logs it to the Order Book when it applies it.
+	// If the ring is full the method returns BACKPRESSURE instead of blocking.
 	// Like in other files, the reason we inline this function is for better performance 
 	// We want the requests to be submitted as fast as possible
-	inline bool submit_trade(TradeNode & tn) {
-		std::unique_lock<std::mutex> lock(mt);
+	inline SubmitStatus submit_trade(const TradeNode & tn) {
+		OrderMessage msg;
+		if (!prepare(m_listing.load(std::memory_order_acquire), tn, msg))
+			return REJECTED;
 
-		// Get the stock name
-		std::string input_stock = tn.request->getInstrument();
+		// Every order gets a unique id, kept on the request for later edits and deletes
+		msg.order.id = m_next_order_id.fetch_add(1, std::memory_order_relaxed);
+		tn.request->setOrderId(msg.order.id);
 
-		// Check if that stock is available in O(log n) time. 
-		// If not, print an error message, release the lock and notify waiting threads
-		if (Stocks.find(input_stock) == Stocks.end()) {
+		// Route the request to the engine that owns the stock. A request that doesn't
+		// make it into the ring gives its reservation and its order id back
+		SubmitStatus status = m_engines[msg.node->id % m_workers]->enqueue(msg);
+		if (status == BACKPRESSURE) {
+			tn.trader->release(reservation(msg.order, msg.node->tick_size, msg.order.quantity));
+			tn.request->setOrderId(0);
+		}
+		return status;
+	}
+
+	// Submits a burst of trades at once. Every trade is validated like in submit_trade(),
+	// then the batch is grouped by engine, keeping the order of the trades of each stock.
+	// The whole batch takes one order id reservation, and every engine gets its part with
+	// one claim of its ring and at most one wake-up, instead of one per trade.
+	// If status is not null, status[i] tells the outcome of trades[i]. A trade that didn't
+	// fit in its engine's ring is BACKPRESSURE and keeps no order id and no reservation.
+	// Returns the number of trades submitted
+	std::size_t submit_trades(const TradeNode * trades, std::size_t count, SubmitStatus * status = nullptr);
+	std::size_t submit_trades(const std::vector<TradeNode> & trades, SubmitStatus * status = nullptr);
+
+private:
+	// Current listing of the stocks. Brokers load it once per request. Listings replaced
+	// intraday are retired but kept until closing, since a broker may still be reading one:
+	// IPOs are rare, thus the memory is a small price for lock-free reads
+	std::atomic<Listing*>						m_listing;
+	std::vector<Listing*>						m_retired;
+	std::mutex									m_listing_mt;	// Serializes listings and halts
+
+	// Tick sizes of the stocks listed intraday
+	double										m_tick_size;
+	std::map<std::string, double>				m_tick_sizes;
+
+	// Matching engines (shards). Stock i is pinned to engine i % m_workers
+	MatchingEngine**							m_engines;
+	std::size_t									m_workers;
+
+	// Next order id. Ids start at 1, 0 means "never submitted"
+	std::atomic<std::uint64_t>					m_next_order_id;
+
+	// Looks the stock of a submission up in a listing, usually in one probe, then validates
+	// it and builds its message (see prepare_order). Returns false, and reports the reject
+	// to the trader, if the stock is not listed or the request is bad
+	inline bool prepare(const Listing * listing, const TradeNode & tn, OrderMessage & msg) {
+		std::uint32_t index = listing->symbols.find(tn.request->getInstrument());
+		if (index == SymbolTable::npos) {
 			std::cerr << "Bad trade request! Stock doesn't exist.\n";
-			lock.unlock();
-			cv.notify_all();
+			report_reject(tn.trader, 0, tn.request->getId(), index, tn.request->getSide(), REJECT_UNKNOWN_STOCK);
 			return false;
 		}
+		return prepare_order(*listing->nodes[index], tn, msg);
+	}
 
-		// Get the index by hashing the stock name
-		// This allows constant time querries to the exchange
-		m_index = hash(input_stock);
-		
-		// Get the trading side
-		std::string side = tn.request->getSide();
-
-		// Submit a BUY order
-		if (side == "BUY") {
-			m_exchange[m_index].buy_heap.push(tn);
-			m_exchange[m_index].available	= true;
-			m_exchange[m_index].stock		= input_stock;
-			updateOrderBook(tn);
-			lock.unlock();
-			cv.notify_all();
-			return true;
-		}
+	// Builds and routes an edit or delete message. New prices are converted to ticks here
+	SubmitStatus modify(OrderMessage & msg, const std::string & side, const std::string & instrument, double new_price = 0.0);
 
-		// Submit a SELL order
-		if (side == "SELL") {
-			m_exchange[m_index].sell_heap.push(tn);
-			m_exchange[m_index].available	= true;
-			m_exchange[m_index].stock		= input_stock;
-			updateOrderBook(tn);
-			lock.unlock();
-			cv.notify_all();
-			return true;
-		}
+	// Creates the node of a stock with its tick size, in minor units
+	ExchangeNode* make_node(const std::string & stock, std::uint32_t id, double tick_size);
 
-		// Release the lock in all cases!
-		lock.unlock();
-		cv.notify_all();
-		return false;
-	}
+	// Hands a listing or halt message to the engine of the stock. These must not be lost,
+	// thus a full ring is retried instead of reported
+	void send(const OrderMessage & msg);
 
-private:
-	// Model a hash table using a dynamic array and an elementary hash function
-	ExchangeNode*								m_exchange;
-	std::size_t									m_size;
-	unsigned int								m_index;
-	std::function<std::size_t(std::string)>		hash;
-	std::set<std::string>						Stocks = { "GOOGL", "BABA", "AMZN", "TSLA", "DIS" };
-
-	// Threading shield
-	std::mutex					mt;
-	std::condition_variable		cv;
-	std::thread					ignite;
-
-	// Matching Engine stuff
-	bool exchange_open;
-
-	void matching_engine();
 	void start_engine();
 	void stop_engine();
 
-	// Order Book
-	std::vector<std::string> OrderBook;
-	void updateOrderBook(TradeNode & tn);
-
-	// Fill Book
-	std::vector<std::string> FillBook;
-	
 	// Avoid accidental or intentional copies and clones of the Exchange
 	Exchange(const Exchange&);
 	Exchange& operator=(const Exchange&);
@@ -0,0 +1,343 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	Testing the Exchange and its matching engines
+*
+*/
+
+// Import the necessary files
+#include <iostream>
+#include <map>
+#include <thread>
+#include <vector>
+#include "Exchange.hpp"
+
+int main() {
+
+	std::cout << "*** Testing Exchange functionality ***\n\n";
+	std::cout << std::boolalpha;
+
+	// Test 1: List a stock (IPO) while a broker trades another stock on a running engine.
+	// The new ticker takes the next id and accepts orders, the stocks listed before keep
+	// their ids, and orders resting before the listing can still be deleted
+	std::cout << "*** Test 1:\n\n";
+	{
+		ExchangeConfig config;
+		config.workers = 2;
+		Exchange NYSE(config);
+
+		Trader maker(1'000'000), buyer(1'000'000), seller(1'000'000);
+		AutoRequest resting("BUY", "GOOGL", 100.0, 10);
+		NYSE.submit_trade(TradeNode(&maker, &resting));
+
+		// A broker crosses TSLA orders while the stock is listed
+		const long pairs = 2000;
+		std::thread broker([&NYSE, &buyer, &seller, pairs]() {
+			AutoRequest buy("BUY", "TSLA", 10.0, 1);
+			AutoRequest sell("SELL", "TSLA", 10.0, 1);
+			long i = 0;
+			for (; i < pairs; ++i) {
+				while (NYSE.submit_trade(TradeNode(&buyer, &buy)) == BACKPRESSURE)
+					std::this_thread::yield();
+				while (NYSE.submit_trade(TradeNode(&seller, &sell)) == BACKPRESSURE)
+					std::this_thread::yield();
+			}
+		});
+
+		SubmitStatus listed = NYSE.add_instrument("NVDA");
+		SubmitStatus relisted = NYSE.add_instrument("GOOGL");
+
+		AutoRequest buy_ipo("BUY", "NVDA", 50.0, 5);
+		AutoRequest sell_ipo("SELL", "NVDA", 50.0, 5);
+		SubmitStatus ipo_buy = NYSE.submit_trade(TradeNode(&buyer, &buy_ipo));
+		SubmitStatus ipo_sell = NYSE.submit_trade(TradeNode(&seller, &sell_ipo));
+
+		broker.join();
+		NYSE.flush();
+
+		Quote googl, tsla, nvda;
+		NYSE.get_quote("GOOGL", googl);
+		NYSE.get_quote("TSLA", tsla);
+		NYSE.get_quote("NVDA", nvda);
+
+		std::cout << "NVDA listed: " << (listed == SUBMITTED) << ", GOOGL listed twice: " << (relisted == SUBMITTED) << " (expected true, false)\n";
+		std::cout << "Ids of GOOGL, TSLA, NVDA: " << googl.symbol << ", " << tsla.symbol << ", " << nvda.symbol << " (expected 0, 2, 5)\n";
+		std::cout << "NVDA orders accepted: " << (ipo_buy == SUBMITTED && ipo_sell == SUBMITTED) << " (expected true)\n";
+		std::cout << "Fills: " << NYSE.getFillRecords().size() << " (expected " << pairs + 1 << ")\n";
+
+		SubmitStatus deleted = NYSE.delete_trade(&maker, &resting, "BUY", "GOOGL");
+		NYSE.flush();
+		std::cout << "GOOGL order resting since before the IPO deleted: " << (deleted == SUBMITTED) << " (expected true)\n";
+		std::cout << "Maker's cash all free again: " << (maker.buyingPower() == maker.cash()) << " (expected true)\n\n\n";
+	}
+
+	// Success!
+
+	// Test 2: Halt a stock with orders resting on both sides. The engine cancels them and
+	// gives their reservations back, every cancel is reported, and new orders are rejected
+	std::cout << "*** Test 2:\n\n";
+	{
+		Exchange NYSE;
+		Trader maker(1'000'000);
+		ExecutionReports reports;
+		maker.subscribe(&reports);
+
+		AutoRequest bid("BUY", "DIS", 99.0, 100);
+		AutoRequest ask("SELL", "DIS", 101.0, 100);
+		NYSE.submit_trade(TradeNode(&maker, &bid));
+		NYSE.submit_trade(TradeNode(&maker, &ask));
+		NYSE.flush();
+		Cash reserved = maker.cash() - maker.buyingPower();
+
+		SubmitStatus halted = NYSE.halt_instrument("DIS");
+		SubmitStatus halted_twice = NYSE.halt_instrument("DIS");
+		NYSE.flush();
+
+		long cancels = 0;
+		long long cancelled = 0;
+		ExecutionReport report;
+		while (reports.poll(report))
+			if (report.type == REPORT_CANCEL_ACK) {
+				++cancels;
+				cancelled += report.quantity;
+			}
+
+		Quote quote;
+		NYSE.get_quote("DIS", quote);
+
+		std::cout << "Halted: " << (halted == SUBMITTED) << ", halted twice: " << (halted_twice == SUBMITTED) << " (expected true, false)\n";
+		std::cout << "Cash reserved before the halt: " << (reserved > 0) << ", after: " << maker.cash() - maker.buyingPower() << " (expected true, 0)\n";
+		std::cout << "Cancels reported: " << cancels << ", quantity: " << cancelled << " (expected 2, 200)\n";
+		std::cout << "Quote trading: " << quote.trading << ", bid: " << quote.bid.quantity << ", ask: " << quote.ask.quantity << " (expected 0, 0, 0)\n";
+
+		AutoRequest late("BUY", "DIS", 100.0, 1);
+		SubmitStatus after = NYSE.submit_trade(TradeNode(&maker, &late));
+		std::cout << "Order after the halt: " << (after == REJECTED) << " (expected true, with an error message above)\n\n\n";
+
+		maker.subscribe(nullptr);
+	}
+
+	// Success!
+
+	// Test 3: Submit a batch larger than the engine's ring. The ring takes what fits in one
+	// claim, the rest is BACKPRESSURE: those trades keep no order id and no reservation
+	std::cout << "*** Test 3:\n\n";
+	{
+		ExchangeConfig config;
+		config.ring_capacity = 8;
+		Exchange NYSE(config);
+		Trader trader(1'000'000);
+
+		const std::size_t count = 20;
+		std::vector<Request*> requests;
+		std::vector<TradeNode> batch;
+		std::size_t i = 0;
+		for (; i < count; ++i) {
+			requests.push_back(new AutoRequest("BUY", "GOOGL", 10.0, 1));
+			batch.push_back(TradeNode(&trader, requests[i]));
+		}
+
+		SubmitStatus status[count];
+		std::size_t submitted = NYSE.submit_trades(batch, status);
+		NYSE.flush();
+
+		std::size_t accepted = 0, pushed_back = 0;
+		bool ids = true;
+		for (i = 0; i < count; ++i) {
+			if (status[i] == SUBMITTED && requests[i]->getOrderId() != 0)
+				++accepted;
+			else if (status[i] == BACKPRESSURE && requests[i]->getOrderId() == 0)
+				++pushed_back;
+			else
+				ids = false;
+		}
+
+		std::cout << "Submitted: " << submitted << " (expected 8)\n";
+		std::cout << "Trades SUBMITTED with an id: " << accepted << ", BACKPRESSURE with id 0: " << pushed_back << " (expected 8, 12)\n";
+		std::cout << "Every status matches its order id: " << ids << " (expected true)\n";
+		std::cout << "Cash reserved: $" << to_dollars(trader.cash() - trader.buyingPower()) << " (expected $80, for the 8 resting orders)\n";
+
+		// The trades turned away can be sent again, as the engine drains the ring
+		std::size_t resubmitted = 0;
+		for (i = 0; i < count; ++i) {
+			if (status[i] != BACKPRESSURE)
+				continue;
+			while ((status[i] = NYSE.submit_trade(batch[i])) == BACKPRESSURE)
+				std::this_thread::yield();
+			if (status[i] == SUBMITTED)
+				++resubmitted;
+		}
+		NYSE.flush();
+
+		std::cout << "Resubmitted one by one: " << resubmitted << " (expected 12)\n";
+		std::cout << "Orders: " << NYSE.getOrderRecords().size() << " (expected 20)\n\n\n";
+
+		for (i = 0; i < count; ++i)
+			delete requests[i];
+	}
+
+	// Success!
+
+	// Test 4: Run to completion. The engines start no thread and several brokers match on
+	// their own threads, two per stock. The books still apply every stock's messages one at
+	// a time in sequence order, every broker's orders in the order it sent them, and every
+	// order fills
+	std::cout << "*** Test 4:\n\n";
+	{
+		ExchangeConfig config;
+		config.workers = 2;
+		config.run_to_completion = true;
+		config.ring_capacity = 256;
+		Exchange NYSE(config);
+
+		const std::size_t producers = 4;
+		const long pairs = 2000;
+		std::vector<Trader*> buyers, sellers;
+		std::vector<std::thread> threads;
+		std::size_t p = 0;
+		for (; p < producers; ++p) {
+			buyers.push_back(new Trader(1'000'000));
+			sellers.push_back(new Trader(1'000'000));
+		}
+		for (p = 0; p < producers; ++p)
+			threads.push_back(std::thread([&NYSE, &config, &buyers, &sellers, p, pairs]() {
+				AutoRequest sell("SELL", config.symbols[p % 2], 10.0, 1);
+				AutoRequest buy("BUY", config.symbols[p % 2], 10.0, 1);
+				long i = 0;
+				for (; i < pairs; ++i) {
+					while (NYSE.submit_trade(TradeNode(sellers[p], &sell)) == BACKPRESSURE)
+						std::this_thread::yield();
+					while (NYSE.submit_trade(TradeNode(buyers[p], &buy)) == BACKPRESSURE)
+						std::this_thread::yield();
+				}
+			}));
+		for (p = 0; p < producers; ++p)
+			threads[p].join();
+		NYSE.flush();
+
+		std::vector<OrderRecord> orders = NYSE.getOrderRecords();
+		std::vector<FillRecord> fills = NYSE.getFillRecords();
+
+		// Sequence numbers grow along the records of every stock, and the order ids of
+		// every trader grow along its records
+		bool sequenced = true, in_order = true;
+		std::map<unsigned int, std::uint64_t> last_sequence;
+		std::map<std::uint64_t, std::uint64_t> last_order;
+		for (const OrderRecord & record : orders) {
+			if (record.sequence <= last_sequence[record.symbol])
+				sequenced = false;
+			if (record.order_id <= last_order[record.trader_id])
+				in_order = false;
+			last_sequence[record.symbol] = record.sequence;
+			last_order[record.trader_id] = record.order_id;
+		}
+
+		long long filled = 0;
+		last_sequence.clear();
+		for (const FillRecord & record : fills) {
+			if (record.sequence < last_sequence[record.symbol])
+				sequenced = false;
+			last_sequence[record.symbol] = record.sequence;
+			filled += record.quantity;
+		}
+
+		bool settled = true;
+		for (p = 0; p < producers; ++p)
+			if (to_dollars(buyers[p]->cash()) != 1'000'000 - 10.0 * pairs || to_dollars(sellers[p]->cash()) != 1'000'000 + 10.0 * pairs
+				|| buyers[p]->buyingPower() != buyers[p]->cash() || sellers[p]->buyingPower() != sellers[p]->cash())
+				settled = false;
+
+		std::cout << "Orders: " << orders.size() << " (expected " << 2 * pairs * producers << ")\n";
+		std::cout << "Filled quantity: " << filled << " (expected " << pairs * producers << ")\n";
+		std::cout << "Every stock in sequence order: " << sequenced << " (expected true)\n";
+		std::cout << "Every broker's orders in the order sent: " << in_order << " (expected true)\n";
+		std::cout << "Every trader settled, no cash left reserved: " << settled << " (expected true)\n\n\n";
+
+		for (p = 0; p < producers; ++p) {
+			delete buyers[p];
+			delete sellers[p];
+		}
+	}
+
+	// Success!
+
+	// Test 5: Submit one by one into a tiny ring until it is full. The submission that gets
+	// BACKPRESSURE leaves its request with order id 0 and its trader with no cash reserved
+	// for it, thus it can't be edited or deleted by mistake and can simply be sent again
+	std::cout << "*** Test 5:\n\n";
+	{
+		ExchangeConfig config;
+		config.ring_capacity = 2;
+		Exchange NYSE(config);
+		Trader trader(1'000'000);
+
+		AutoRequest request("BUY", "AMZN", 10.0, 1);
+		long submitted = 0, attempts = 0;
+		SubmitStatus status = SUBMITTED;
+		for (; attempts < 10000 && status != BACKPRESSURE; ++attempts)
+			if ((status = NYSE.submit_trade(TradeNode(&trader, &request))) == SUBMITTED)
+				++submitted;
+		NYSE.flush();
+
+		SubmitStatus deleted = NYSE.delete_trade(&trader, &request, "BUY", "AMZN");
+		std::cout << "Ring filled up: " << (status == BACKPRESSURE) << " (expected true)\n";
+		std::cout << "Order id of the request turned away: " << request.getOrderId() << " (expected 0)\n";
+		std::cout << "Cash reserved for the orders that made it: " << (trader.cash() - trader.buyingPower() == submitted * to_cash(10.0))
+			<< " (expected true)\n";
+		std::cout << "Delete of the request turned away: " << (deleted == REJECTED) << " (expected true)\n\n\n";
+	}
+
+	// Success!
+
+	// Test 6: Halt a stock while a broker submits to it on another thread. An order can pass
+	// the halt check at the door and reach the engine after the HALT message: the engine
+	// rejects it and gives its reservation back, thus nothing rests in the halted book
+	std::cout << "*** Test 6:\n\n";
+	{
+		Exchange NYSE;
+		Trader trader(1'000'000);
+		ExecutionReports reports(1 << 16);
+		trader.subscribe(&reports);
+
+		// The broker stops at the first order turned away at the door
+		std::atomic<long> submitted(0);
+		std::thread broker([&NYSE, &trader, &submitted]() {
+			AutoRequest bid("BUY", "BABA", 10.0, 1);
+			SubmitStatus status;
+			while ((status = NYSE.submit_trade(TradeNode(&trader, &bid))) != REJECTED)
+				if (status == SUBMITTED)
+					submitted.fetch_add(1, std::memory_order_relaxed);
+				else
+					std::this_thread::yield();
+		});
+
+		while (submitted.load(std::memory_order_relaxed) < 1000)
+			std::this_thread::yield();
+		NYSE.halt_instrument("BABA");
+		broker.join();
+		NYSE.flush();
+
+		long cancels = 0, rejects = 0;
+		ExecutionReport report;
+		while (reports.poll(report))
+			if (report.type == REPORT_CANCEL_ACK)
+				++cancels;
+			else if (report.type == REPORT_REJECT && report.reason == REJECT_HALTED && report.order_id != 0)
+				++rejects;
+
+		BookDepth depth;
+		NYSE.get_depth("BABA", depth);
+		std::cout << "Every order cancelled by the halt or rejected after it: " << (cancels + rejects == submitted.load()) << " (expected true)\n";
+		std::cout << "Cash all free: " << (trader.buyingPower() == trader.cash()) << " (expected true)\n";
+		std::cout << "Bid levels: " << depth.bid_levels << ", ask levels: " << depth.ask_levels << " (expected 0, 0, with an error message above)\n\n\n";
+
+		trader.subscribe(nullptr);
+	}
+
+	// Success!
+
+	return 0;
+}
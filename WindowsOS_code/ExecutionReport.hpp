@@ -0,0 +1,106 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	ExecutionReport definition and ExecutionReports implementation
+*
+*/
+
+// Multiple inclusion guards to avoid linker errors
+// In case this file is included in multiple source files
+// we want to avoid re-compilations
+#ifndef EXECUTION_REPORT_HPP
+#define EXECUTION_REPORT_HPP
+
+#include <atomic>
+#include <cstdint>
+
+#include "FixedPoint.hpp"
+#include "MPSCQueue.hpp"
+
+//*** ExecutionReport data structure ***//
+
+// What happened to an order
+enum ReportType : unsigned char {
+	REPORT_FILL,			// The order traded and is done
+	REPORT_PARTIAL_FILL,	// The order traded and leaves quantity open
+	REPORT_CANCEL_ACK,		// The order left the book without trading: deleted, or the
+							// remainder of an IOC, fill-or-kill or market order
+	REPORT_REJECT			// The submission, edit or delete was turned away
+};
+
+// Why a request was turned away
+enum RejectReason : unsigned char {
+	REJECT_NONE,
+	REJECT_UNKNOWN_STOCK,	// The stock is not listed
+	REJECT_HALTED,			// The stock is halted
+	REJECT_BAD_REQUEST,		// Bad side, type, price or quantity
+	REJECT_CREDIT,			// The trader can't cover the order or the edit
+	REJECT_UNKNOWN_ORDER	// No resting order of the trader matches the edit or delete
+};
+
+// One event on one order, as delivered to the trader that owns it. A plain struct of
+// integers, thus it is copied into the trader's queue as is and never formatted.
+// Prices are ticks of the stock: to_price(price, tick_size) gives dollars
+struct ExecutionReport {
+	std::uint64_t	order_id;		// Order of the event. 0 if a submission was rejected before it got one
+	std::uint64_t	request_id;		// Request of a rejected submission, 0 otherwise
+	std::uint64_t	sequence;		// Engine sequence number of the message behind the event. 0 at the door
+	long long		timestamp;		// Nanoseconds since epoch (Clock)
+	Ticks			price;			// Fill price of a fill, 0 otherwise
+	long long		quantity;		// Filled quantity of a fill, cancelled quantity of a cancel
+	long long		leaves;			// Quantity still open after the event
+	Cash			tick_size;
+	std::uint32_t	symbol;			// Index of the stock in the Exchange
+	unsigned char	side;			// SIDE_BUY or SIDE_SELL
+	ReportType		type;
+	RejectReason	reason;			// REJECT_NONE unless type is REPORT_REJECT
+
+	ExecutionReport() : order_id(0), request_id(0), sequence(0), timestamp(0), price(0), quantity(0), leaves(0),
+		tick_size(0), symbol(0), side(0), type(REPORT_FILL), reason(REJECT_NONE) {}
+};
+
+//*** ExecutionReports class ***//
+
+// Subscription of a trader to the reports of its orders (see Trader::subscribe).
+// The matching engines push a report as soon as they apply the event, and the Exchange
+// pushes the rejects at the door, into the trader's own lock-free ring. The client polls
+// the ring on its own thread, thus it learns about its orders in O(1) per event, however
+// long the session has been, and never scans or copies the books.
+// Every engine of the Exchange may report on the same trader, thus the ring has many
+// producers and one consumer (the client). A producer never waits for the client: if the
+// ring is full the report is dropped and counted, thus a slow client can't stall matching.
+// Size the ring for the bursts the client can fall behind on.
+class ExecutionReports {
+public:
+	// The constructor allocates the ring upfront
+	ExecutionReports(std::size_t capacity = 4096) : m_queue(capacity), m_dropped(0) {}
+
+	// Producer side. Called by the engines and the Exchange
+	inline void push(const ExecutionReport & report) {
+		if (!m_queue.push(report))
+			m_dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// Consumer side. Only the client calls it. Returns false if there is no new report
+	inline bool poll(ExecutionReport & report) {
+		return m_queue.pop(report);
+	}
+
+	// Reports lost to a full ring
+	inline std::uint64_t dropped() const {
+		return m_dropped.load(std::memory_order_relaxed);
+	}
+
+private:
+	MPSCQueue<ExecutionReport>		m_queue;
+	std::atomic<std::uint64_t>		m_dropped;
+
+	// No copies of a subscription: the engines hold a pointer to it
+	ExecutionReports(const ExecutionReports &);
+	ExecutionReports& operator=(const ExecutionReports &);
+};
+
+#endif // !EXECUTION_REPORT_HPP
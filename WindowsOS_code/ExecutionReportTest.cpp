@@ -0,0 +1,150 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	Testing the execution reports of the Exchange
+*
+*/
+
+// Import the necessary files
+#include <iostream>
+#include <map>
+#include <thread>
+#include <vector>
+#include "Exchange.hpp"
+
+// Names of the report types, as printed below
+static const char * report_names[] = { "FILL", "PARTIAL", "CANCEL", "REJECT" };
+
+int main() {
+
+	std::cout << "*** Testing ExecutionReport functionality ***\n\n";
+	std::cout << std::boolalpha;
+
+	// Test 1: The life of an order, as its trader sees it. The reports of an order arrive
+	// in the order the engine applied the events, with growing sequence numbers
+	std::cout << "*** Test 1:\n\n";
+	{
+		Exchange NYSE;
+		Trader buyer(1'000'000), seller(1'000'000);
+		ExecutionReports reports;
+		buyer.subscribe(&reports);
+
+		AutoRequest bid("BUY", "GOOGL", 100.0, 10);
+		AutoRequest sell1("SELL", "GOOGL", 100.0, 4), sell2("SELL", "GOOGL", 100.0, 6);
+		AutoRequest rest("BUY", "GOOGL", 90.0, 5);
+		NYSE.submit_trade(TradeNode(&buyer, &bid));
+		NYSE.submit_trade(TradeNode(&seller, &sell1));
+		NYSE.submit_trade(TradeNode(&seller, &sell2));
+		NYSE.submit_trade(TradeNode(&buyer, &rest));
+		NYSE.delete_trade(&buyer, &rest, "BUY", "GOOGL");
+		NYSE.delete_trade(&buyer, &rest, "BUY", "GOOGL");
+		NYSE.flush();
+
+		std::vector<ExecutionReport> received;
+		ExecutionReport report;
+		while (reports.poll(report))
+			received.push_back(report);
+
+		bool sequenced = true;
+		std::size_t i = 0;
+		for (; i < received.size(); ++i) {
+			std::cout << report_names[received[i].type] << " " << received[i].quantity << ", leaves " << received[i].leaves << "\n";
+			if (i > 0 && received[i].sequence <= received[i - 1].sequence)
+				sequenced = false;
+		}
+		std::cout << "(expected PARTIAL 4, leaves 6; FILL 6, leaves 0; CANCEL 5, leaves 0; REJECT 0, leaves 0)\n";
+		std::cout << "Reject reason of the second delete: " << (received.size() == 4 && received[3].reason == REJECT_UNKNOWN_ORDER) << " (expected true)\n";
+		std::cout << "Sequence numbers grow: " << sequenced << " (expected true)\n";
+		std::cout << "Reports dropped: " << reports.dropped() << " (expected 0)\n\n\n";
+
+		buyer.subscribe(nullptr);
+	}
+
+	// Success!
+
+	// Test 2: One trader, stocks on two engines. Each engine reports on its own stocks as it
+	// applies them, thus the reports of every order and of every stock keep their order
+	// however the engines interleave
+	std::cout << "*** Test 2:\n\n";
+	{
+		ExchangeConfig config;
+		config.workers = 2;
+		Exchange NYSE(config);
+		Trader buyer(1'000'000), seller(1'000'000);
+		ExecutionReports reports;
+		buyer.subscribe(&reports);
+
+		// GOOGL is on engine 0 and AMZN on engine 1. Every bid is taken in 5 fills of 1
+		const long orders = 200;
+		std::vector<Request*> requests;
+		long i = 0;
+		for (; i < orders; ++i) {
+			std::string stock = i % 2 == 0 ? "GOOGL" : "AMZN";
+			requests.push_back(new AutoRequest("BUY", stock, 10.0, 5));
+			requests.push_back(new AutoRequest("SELL", stock, 10.0, 1));
+			NYSE.submit_trade(TradeNode(&buyer, requests[2 * i]));
+			int k = 0;
+			for (; k < 5; ++k)
+				while (NYSE.submit_trade(TradeNode(&seller, requests[2 * i + 1])) == BACKPRESSURE)
+					std::this_thread::yield();
+		}
+		NYSE.flush();
+
+		// Per order, the leaves count down 4, 3, 2, 1, 0 and only the last one is a FILL.
+		// Per stock, the sequence numbers grow
+		std::map<std::uint64_t, long long> leaves;
+		std::map<std::uint32_t, std::uint64_t> last_sequence;
+		long received = 0;
+		bool in_order = true;
+		ExecutionReport report;
+		while (reports.poll(report)) {
+			++received;
+			long long expected = leaves.count(report.order_id) != 0 ? leaves[report.order_id] - 1 : 4;
+			if (report.leaves != expected || (report.type == REPORT_FILL) != (expected == 0) || report.sequence <= last_sequence[report.symbol])
+				in_order = false;
+			leaves[report.order_id] = report.leaves;
+			last_sequence[report.symbol] = report.sequence;
+		}
+
+		std::cout << "Reports received: " << received << " (expected " << 5 * orders << ")\n";
+		std::cout << "Every order and every stock in order: " << in_order << " (expected true)\n\n\n";
+
+		buyer.subscribe(nullptr);
+		for (std::size_t r = 0; r < requests.size(); ++r)
+			delete requests[r];
+	}
+
+	// Success!
+
+	// Test 3: A full subscription never stalls the Exchange. Reports that don't fit are
+	// dropped and counted, and the ring keeps the oldest ones
+	std::cout << "*** Test 3:\n\n";
+	{
+		Exchange NYSE;
+		Trader trader(1'000'000);
+		ExecutionReports reports(2);
+		trader.subscribe(&reports);
+
+		AutoRequest unknown("BUY", "NVDA", 10.0, 1);
+		int k = 0;
+		for (; k < 5; ++k)
+			NYSE.submit_trade(TradeNode(&trader, &unknown));
+
+		long received = 0;
+		ExecutionReport report;
+		while (reports.poll(report))
+			if (report.type == REPORT_REJECT && report.reason == REJECT_UNKNOWN_STOCK && report.request_id == unknown.getId())
+				++received;
+
+		std::cout << "Reports received: " << received << ", dropped: " << reports.dropped() << " (expected 2, 3, with 5 error messages above)\n\n\n";
+
+		trader.subscribe(nullptr);
+	}
+
+	// Success!
+
+	return 0;
+}
@@ -0,0 +1,75 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	Fixed-point prices and cash
+*
+*/
+
+// Multiple inclusion guards to avoid linker errors
+// In case this file is included in multiple source files
+// we want to avoid re-compilations
+#ifndef FIXED_POINT_HPP
+#define FIXED_POINT_HPP
+
+#include <cstdint>
+#include <cmath>
+
+//*** Ticks and Cash ***//
+
+// Inside the exchange prices and amounts of money are integers, thus the ladders and
+// the matching engine compare and add them exactly and as fast as the CPU can:
+//	1) Ticks: a price, counted in ticks of the instrument. Every instrument has its own
+//	   tick size (the smallest price increment), e.g. a $0.01 tick turns $1.43 into 143
+//	2) Cash: an amount of money, counted in minor units of 1/10000 of a dollar. This is the
+//	   finest tick of US equities, so every tick size is a whole number of minor units
+//	   and the notional of a trade is a plain integer product
+// Doubles are only used at the front end (Request, Trader constructor, printing), and
+// are converted once when they enter or leave the exchange.
+typedef std::int64_t Ticks;
+typedef std::int64_t Cash;
+
+// Minor units per dollar
+static const Cash cash_scale = 10000;
+
+// Tick size of instruments that don't specify one: one cent
+static const Cash default_tick_size = 100;
+
+// Dollars to minor units, rounded to the nearest unit
+inline Cash to_cash(double dollars) {
+	return (Cash)std::llround(dollars * (double)cash_scale);
+}
+
+// Minor units to dollars, for printing
+inline double to_dollars(Cash cash) {
+	return (double)cash / (double)cash_scale;
+}
+
+// Price in dollars to ticks of the given size, rounded to the nearest tick.
+// Limit prices are checked with on_tick() first: rounding an off-tick limit could
+// trade a buyer above, or a seller below, the price it asked for
+inline Ticks to_ticks(double price, Cash tick_size) {
+	return (Ticks)std::llround(price * (double)cash_scale / (double)tick_size);
+}
+
+// True if a price in dollars is a whole number of ticks of the given size, i.e. converting
+// it to ticks and back gives the same price. The tolerance only absorbs the binary
+// representation error of the double
+inline bool on_tick(double price, Cash tick_size) {
+	double ticks = price * (double)cash_scale / (double)tick_size;
+	return std::fabs(ticks - (double)std::llround(ticks)) < 1e-4;
+}
+
+// Ticks of the given size to a price in dollars, for printing
+inline double to_price(Ticks ticks, Cash tick_size) {
+	return to_dollars(ticks * tick_size);
+}
+
+// Notional of a trade: price times quantity, in minor units
+inline Cash notional(Ticks price, Cash tick_size, long long quantity) {
+	return price * tick_size * (Cash)quantity;
+}
+
+#endif // !FIXED_POINT_HPP
@@ -0,0 +1,58 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	IdGenerator definition and implementation
+*
+*/
+
+// Multiple inclusion guards to avoid linker errors
+// In case this file is included in multiple source files
+// we want to avoid re-compilations
+#ifndef ID_GENERATOR_HPP
+#define ID_GENERATOR_HPP
+
+#include <atomic>
+#include <cstdint>
+
+//*** IdGenerator class ***//
+
+// Unique 64-bit ids for the objects of one kind (traders, requests). Every kind has its
+// own global counter, and every thread takes ids from it in blocks: the thread hands out
+// the ids of its block with a plain increment and only goes back to the shared counter,
+// with one atomic add, when the block runs out. Thus an id costs a couple of nanoseconds,
+// threads creating objects at once never share a cache line, and ids never collide.
+// Ids are unique but not dense: a thread that stops early leaves the rest of its block
+// unused. Ids start at 1, 0 means "no id".
+// This is a template, thus the implementation lives in the header as well
+template <typename T>
+class IdGenerator {
+public:
+	// Ids a thread takes from the shared counter at once
+	static const std::uint64_t block_size = 4096;
+
+	// Returns the next id of the calling thread
+	static inline std::uint64_t next() {
+		thread_local std::uint64_t next_id = 0;
+		thread_local std::uint64_t block_end = 0;
+
+		if (next_id == block_end) {
+			next_id = s_next.fetch_add(block_size, std::memory_order_relaxed);
+			block_end = next_id + block_size;
+		}
+		return next_id++;
+	}
+
+private:
+	static std::atomic<std::uint64_t>	s_next;		// First id of the next block
+
+	// Static interface only
+	IdGenerator();
+};
+
+template <typename T>
+std::atomic<std::uint64_t> IdGenerator<T>::s_next(1);
+
+#endif // !ID_GENERATOR_HPP
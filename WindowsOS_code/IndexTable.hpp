@@ -0,0 +1,171 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	IndexTable definition and implementation
+*
+*/
+
+// Multiple inclusion guards to avoid linker errors
+// In case this file is included in multiple source files
+// we want to avoid re-compilations
+#ifndef INDEX_TABLE_HPP
+#define INDEX_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+//*** IndexTable class ***//
+
+// Hash table from an integer key (an order id, a price in ticks) to a value, with open
+// addressing and linear probing. All slots live in one array allocated upfront, thus,
+// unlike std::unordered_map, inserting and erasing never allocate a node and a lookup
+// usually reads a single cache line. Erasing shifts the following entries of the probe
+// sequence back, so there are no tombstones and lookups stay short.
+// The table keeps at most half of its slots used. If it outgrows its reservation it
+// doubles and rehashes, which allocates, so large tables are sized when the Exchange opens
+// and small ones, like the price index of a ladder, start small and grow on demand.
+// This is a template, thus the implementation lives in the header as well
+template <typename Key, typename Value>
+class IndexTable {
+public:
+	// The constructor reserves room for the given number of entries
+	IndexTable(std::size_t capacity = 16) : m_slots(nullptr), m_mask(0), m_size(0), m_rehashes(0) {
+		allocate(slots_for(capacity));
+	}
+
+	~IndexTable() {
+		delete[] m_slots;
+	}
+
+	// Makes room for the given number of entries, without growing later
+	void reserve(std::size_t capacity) {
+		std::size_t slots = slots_for(capacity);
+		if (slots > m_mask + 1)
+			rehash(slots);
+	}
+
+	// Returns a pointer to the value of a key, or nullptr if the key is absent
+	inline Value* find(Key key) {
+		std::size_t i = hash(key) & m_mask;
+		for (;; i = (i + 1) & m_mask) {
+			if (!m_slots[i].used)
+				return nullptr;
+			if (m_slots[i].key == key)
+				return &m_slots[i].value;
+		}
+	}
+
+	// Inserts a key, or assigns its value if it is already present
+	inline void insert(Key key, Value value) {
+		if (2 * (m_size + 1) > m_mask + 1) {
+			rehash(2 * (m_mask + 1));
+			++m_rehashes;
+		}
+
+		std::size_t i = hash(key) & m_mask;
+		for (; m_slots[i].used; i = (i + 1) & m_mask)
+			if (m_slots[i].key == key) {
+				m_slots[i].value = value;
+				return;
+			}
+
+		m_slots[i].key = key;
+		m_slots[i].value = value;
+		m_slots[i].used = true;
+		++m_size;
+	}
+
+	// Removes a key. Returns false if the key is absent
+	inline bool erase(Key key) {
+		std::size_t i = hash(key) & m_mask;
+		for (;; i = (i + 1) & m_mask) {
+			if (!m_slots[i].used)
+				return false;
+			if (m_slots[i].key == key)
+				break;
+		}
+
+		// Backward shift: move up every following entry that would not be
+		// reachable anymore once the hole is left open
+		std::size_t hole = i;
+		std::size_t j = (i + 1) & m_mask;
+		for (; m_slots[j].used; j = (j + 1) & m_mask) {
+			std::size_t home = hash(m_slots[j].key) & m_mask;
+			if (((j - home) & m_mask) >= ((j - hole) & m_mask)) {
+				m_slots[hole] = m_slots[j];
+				hole = j;
+			}
+		}
+		m_slots[hole].used = false;
+		--m_size;
+		return true;
+	}
+
+	// Auxiliary features
+	const std::size_t size() { return m_size; }				// Number of entries
+	const std::size_t capacity() { return (m_mask + 1) / 2; }	// Entries that fit without growing
+	const std::size_t rehashes() { return m_rehashes; }		// Times the table had to grow
+
+private:
+	struct Slot {
+		Key		key;
+		Value	value;
+		bool	used;
+	};
+
+	Slot*			m_slots;
+	std::size_t		m_mask;			// Number of slots - 1
+	std::size_t		m_size;
+	std::size_t		m_rehashes;
+
+	// Mixes the bits of the key (64-bit finalizer of MurmurHash3), thus sequential
+	// order ids and neighbouring prices spread over the whole table
+	static inline std::size_t hash(Key key) {
+		std::uint64_t x = (std::uint64_t)key;
+		x ^= x >> 33;
+		x *= 0xff51afd7ed558ccdULL;
+		x ^= x >> 33;
+		x *= 0xc4ceb9fe1a85ec53ULL;
+		x ^= x >> 33;
+		return (std::size_t)x;
+	}
+
+	// Power of two number of slots that keeps the table at most half full
+	static std::size_t slots_for(std::size_t capacity) {
+		std::size_t slots = 16;
+		while (slots < 2 * capacity)
+			slots <<= 1;
+		return slots;
+	}
+
+	void allocate(std::size_t slots) {
+		m_slots = new Slot[slots];
+		m_mask = slots - 1;
+		std::size_t i = 0;
+		for (; i < slots; ++i)
+			m_slots[i].used = false;
+	}
+
+	void rehash(std::size_t slots) {
+		Slot* old = m_slots;
+		std::size_t old_slots = m_mask + 1;
+
+		allocate(slots);
+		m_size = 0;
+
+		std::size_t i = 0;
+		for (; i < old_slots; ++i)
+			if (old[i].used)
+				insert(old[i].key, old[i].value);
+		delete[] old;
+	}
+
+	// No copies of a table
+	IndexTable(const IndexTable &);
+	IndexTable& operator=(const IndexTable &);
+};
+
+#endif // !INDEX_TABLE_HPP
@@ -0,0 +1,347 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	Journal and JournalReader implementation
+*
+*/
+
+#include "Journal.hpp"
+
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//*** Platform layer ***//
+
+// Creates a zero-filled file of the given size and maps it for writing
+static bool map_for_writing(const std::string & path, std::size_t size, MappedSegment & segment) {
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+		CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER length;
+	length.QuadPart = (LONGLONG)size;
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, length.HighPart, length.LowPart, nullptr);
+	if (mapping == nullptr) {
+		CloseHandle(file);
+		return false;
+	}
+
+	void* base = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+	if (base == nullptr) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	segment.file = (std::intptr_t)file;
+	segment.mapping = (std::intptr_t)mapping;
+#else
+	int file = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (file < 0)
+		return false;
+
+	if (::ftruncate(file, (off_t)size) != 0) {
+		::close(file);
+		return false;
+	}
+
+	void* base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+	if (base == MAP_FAILED) {
+		::close(file);
+		return false;
+	}
+
+	segment.file = file;
+#endif
+	segment.base = static_cast<char*>(base);
+	segment.size = size;
+	return true;
+}
+
+// Maps an existing file for reading. Returns false if the file doesn't exist
+static bool map_for_reading(const std::string & path, MappedSegment & segment) {
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER length;
+	if (!GetFileSizeEx(file, &length) || length.QuadPart == 0) {
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		CloseHandle(file);
+		return false;
+	}
+
+	void* base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (base == nullptr) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	segment.file = (std::intptr_t)file;
+	segment.mapping = (std::intptr_t)mapping;
+	segment.size = (std::size_t)length.QuadPart;
+#else
+	int file = ::open(path.c_str(), O_RDONLY);
+	if (file < 0)
+		return false;
+
+	struct stat info;
+	if (::fstat(file, &info) != 0 || info.st_size == 0) {
+		::close(file);
+		return false;
+	}
+
+	void* base = ::mmap(nullptr, (std::size_t)info.st_size, PROT_READ, MAP_SHARED, file, 0);
+	if (base == MAP_FAILED) {
+		::close(file);
+		return false;
+	}
+
+	segment.file = file;
+	segment.size = (std::size_t)info.st_size;
+#endif
+	segment.base = static_cast<char*>(base);
+	return true;
+}
+
+// Touches every page of a new mapping, thus the page faults are taken now and not by
+// the first records written to it
+static void prefault_segment(MappedSegment & segment) {
+	const std::size_t page = 4096;
+	volatile char* base = segment.base;
+	std::size_t offset = 0;
+	for (; offset < segment.size; offset += page)
+		base[offset] = 0;
+}
+
+// Writes the dirty pages of a mapping back to the file. Asynchronous flushes only
+// schedule the write, synchronous ones wait for it
+static void flush_segment(MappedSegment & segment, bool synchronous) {
+	if (segment.base == nullptr)
+		return;
+#ifdef _WIN32
+	FlushViewOfFile(segment.base, segment.size);
+	if (synchronous)
+		FlushFileBuffers((HANDLE)segment.file);
+#else
+	::msync(segment.base, segment.size, synchronous ? MS_SYNC : MS_ASYNC);
+#endif
+}
+
+// Unmaps a segment and closes its file
+static void unmap_segment(MappedSegment & segment) {
+	if (segment.base == nullptr)
+		return;
+#ifdef _WIN32
+	UnmapViewOfFile(segment.base);
+	CloseHandle((HANDLE)segment.mapping);
+	CloseHandle((HANDLE)segment.file);
+#else
+	::munmap(segment.base, segment.size);
+	::close((int)segment.file);
+#endif
+	segment = MappedSegment();
+}
+
+//*** Journal implementation ***//
+
+// The constructor opens the first segment. On failure the journal stays closed
+Journal::Journal(const std::string & directory, const std::string & name, std::size_t segment_size)
+	: m_directory(directory), m_name(name), m_segment_size(padded(segment_size)), m_segment_number(0), m_offset(0), m_records(0),
+	m_next_number(1), m_next_pending(true), m_next_ready(false), m_stop(false) {
+
+	// A journal starts over: segments left by an earlier run of the same name would be
+	// read back after the new ones, thus they are removed first
+	std::size_t stale = 1;
+	while (std::remove(segment_path(m_directory, m_name, stale).c_str()) == 0)
+		++stale;
+
+	if (!map_for_writing(segment_path(m_directory, m_name, 0), m_segment_size, m_segment)) {
+		std::cerr << "Journal " << m_name << " cannot open " << segment_path(m_directory, m_name, 0) << "! Journaling disabled.\n";
+		return;
+	}
+	prefault_segment(m_segment);
+
+	// The second segment is prepared while the first one fills
+	m_preparer = std::thread{ &Journal::prepare, this };
+}
+
+// The destructor makes the current segment durable and releases it. A prepared segment
+// that was never written to is removed, thus readers only find the written ones
+Journal::~Journal() {
+	flush_segment(m_segment, true);
+	unmap_segment(m_segment);
+
+	if (m_preparer.joinable()) {
+		std::unique_lock<std::mutex> lock(m_prepare_mt);
+		m_stop = true;
+		lock.unlock();
+		m_prepare_cv.notify_all();
+		m_preparer.join();
+	}
+
+	if (m_next.base != nullptr) {
+		unmap_segment(m_next);
+		std::remove(segment_path(m_directory, m_name, m_next_number).c_str());
+	}
+}
+
+// Runs on the background thread. Unmaps the segments the writer retired, and creates,
+// maps and pre-faults the next segment whenever the writer took the prepared one.
+// The file system calls and the page faults happen here, out of the lock
+void Journal::prepare() {
+	std::unique_lock<std::mutex> lock(m_prepare_mt);
+	for (;;) {
+		m_prepare_cv.wait(lock, [this]() { return m_stop || m_retired.base != nullptr || m_next_pending; });
+
+		if (m_retired.base != nullptr) {
+			MappedSegment retired = m_retired;
+			m_retired = MappedSegment();
+			lock.unlock();
+			flush_segment(retired, false);
+			unmap_segment(retired);
+			lock.lock();
+		}
+
+		if (m_next_pending) {
+			std::size_t number = m_next_number;
+			m_next_pending = false;
+			lock.unlock();
+
+			MappedSegment next;
+			if (map_for_writing(segment_path(m_directory, m_name, number), m_segment_size, next))
+				prefault_segment(next);
+
+			lock.lock();
+			m_next = next;
+			m_next_ready = true;
+			m_prepare_cv.notify_all();
+		}
+
+		if (m_stop && m_retired.base == nullptr)
+			return;
+	}
+}
+
+// Segment files are numbered: <directory>/<name>.000000.journal, <name>.000001.journal, ...
+std::string Journal::segment_path(const std::string & directory, const std::string & name, std::size_t segment) {
+	char number[16];
+	std::snprintf(number, sizeof(number), "%06u", (unsigned)segment);
+	return directory + "/" + name + "." + number + ".journal";
+}
+
+// Closes the current segment with an end marker and switches to the prepared one. The
+// full segment is handed to the background thread, which schedules its write-back, unmaps
+// it and prepares the segment after. A record that can never fit in a segment is refused
+bool Journal::roll(std::size_t needed) {
+	if (m_segment.base == nullptr)
+		return false;
+
+	if (needed + sizeof(JournalEntry) > m_segment_size) {
+		std::cerr << "Journal " << m_name << ": record larger than a segment!\n";
+		return false;
+	}
+
+	reinterpret_cast<JournalEntry*>(m_segment.base + m_offset)->type = JOURNAL_END;
+
+	// The next segment is usually ready long before the current one fills
+	std::unique_lock<std::mutex> lock(m_prepare_mt);
+	m_prepare_cv.wait(lock, [this]() { return m_next_ready; });
+
+	m_retired = m_segment;
+	m_segment = m_next;
+	m_next = MappedSegment();
+	m_next_ready = false;
+
+	++m_segment_number;
+	m_offset = 0;
+	m_next_number = m_segment_number + 1;
+	m_next_pending = m_segment.base != nullptr;
+	lock.unlock();
+	m_prepare_cv.notify_all();
+
+	if (m_segment.base == nullptr) {
+		std::cerr << "Journal " << m_name << " cannot roll over! Journaling disabled.\n";
+		return false;
+	}
+	return true;
+}
+
+// Schedules the write-back of the current segment
+void Journal::sync() {
+	flush_segment(m_segment, false);
+}
+
+// Boolean method to check whether or not the journal is writable
+bool Journal::is_open() {
+	return m_segment.base != nullptr;
+}
+
+// Getter method for the number of segments
+const std::size_t Journal::segments() {
+	return m_segment_number + 1;
+}
+
+// Getter method for the number of records
+const std::size_t Journal::records() {
+	return m_records;
+}
+
+//*** JournalReader implementation ***//
+
+// The constructor maps the first segment, if there is one
+JournalReader::JournalReader(const std::string & directory, const std::string & name)
+	: m_directory(directory), m_name(name), m_segment_number(0), m_offset(0) {
+	map_for_reading(Journal::segment_path(m_directory, m_name, 0), m_segment);
+}
+
+// The destructor releases the current segment
+JournalReader::~JournalReader() {
+	unmap_segment(m_segment);
+}
+
+// Moves to the next segment. Returns false if there is none
+bool JournalReader::open_next() {
+	unmap_segment(m_segment);
+	++m_segment_number;
+	m_offset = 0;
+	return map_for_reading(Journal::segment_path(m_directory, m_name, m_segment_number), m_segment);
+}
+
+// Returns the entry at the read position and moves past it. An end marker (or the end
+// of the file) sends the reader to the next segment
+const JournalEntry* JournalReader::next() {
+	while (m_segment.base != nullptr) {
+		if (m_offset + sizeof(JournalEntry) <= m_segment.size) {
+			const JournalEntry* entry = reinterpret_cast<const JournalEntry*>(m_segment.base + m_offset);
+			if (entry->type != JOURNAL_END && m_offset + sizeof(JournalEntry) + entry->size <= m_segment.size) {
+				m_offset += sizeof(JournalEntry) + Journal::padded(entry->size);
+				return entry;
+			}
+		}
+		if (!open_next())
+			return nullptr;
+	}
+	return nullptr;
+}
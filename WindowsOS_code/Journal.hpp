@@ -0,0 +1,180 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	Journal and JournalReader definition
+*
+*/
+
+// Multiple inclusion guards to avoid linker errors
+// In case this file is included in multiple source files
+// we want to avoid re-compilations
+#ifndef JOURNAL_HPP
+#define JOURNAL_HPP
+
+#include <iostream>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+//*** JournalEntry data structure ***//
+
+// Every record in a journal segment is framed by this header and followed by its
+// payload. Payloads are padded to 8 bytes, thus every header and every payload in the
+// mapped file is aligned and can be read in place. A zero type marks the end of the
+// written part of a segment (the file is pre-sized and zero filled)
+enum JournalRecordType : std::uint32_t {
+	JOURNAL_END		= 0,
+	JOURNAL_ORDER	= 1,	// Payload is an OrderRecord
+	JOURNAL_FILL	= 2,	// Payload is a FillRecord
+	JOURNAL_MESSAGE	= 3		// Payload is a MessageRecord
+};
+
+struct JournalEntry {
+	std::uint32_t	type;		// JournalRecordType
+	std::uint32_t	size;		// Payload size in bytes, without the padding
+
+	// Zero-copy access to the payload, inside the mapped file
+	inline const void* data() const {
+		return reinterpret_cast<const char*>(this) + sizeof(JournalEntry);
+	}
+
+	template <typename T>
+	inline const T* as() const {
+		return reinterpret_cast<const T*>(data());
+	}
+};
+
+//*** MappedSegment data structure ***//
+
+// One memory-mapped segment file. Platform specific handles are kept opaque,
+// the implementation supports both Windows and POSIX systems
+struct MappedSegment {
+	char*			base;		// Start of the mapping
+	std::size_t		size;		// Size of the file and of the mapping
+	std::intptr_t	file;		// File descriptor or HANDLE
+	std::intptr_t	mapping;	// Mapping HANDLE (Windows only)
+
+	MappedSegment() : base(nullptr), size(0), file(-1), mapping(0) {}
+};
+
+//*** Journal class ***//
+
+// Append-only binary journal of the Order and Fill books, written to memory-mapped
+// segment files of a fixed, pre-allocated size: <directory>/<name>.<segment number>.journal
+// Appending a record is a copy into the mapping, thus the matching engine never waits for
+// a system call on the hot path and the operating system writes the pages back in the
+// background. When a segment is full the journal rolls over to the next one.
+// The next segment is created, mapped and pre-faulted ahead of time by a background thread
+// of the journal, which also unmaps the full ones. Rolling over is then a swap of two
+// mappings: the matching engine never waits for a file system call or a page fault,
+// unless it fills segments faster than the background thread can prepare them.
+// A journal has a single writer: every matching engine owns its own journal.
+// Errors are reported on std::cerr and disable the journal, like the rest of the system
+// they never stop the exchange.
+class Journal {
+public:
+	// The constructor creates (or overwrites) the first segment and maps it, and starts
+	// preparing the second one. Older segments of the same name are removed. The directory must exist
+	Journal(const std::string & directory, const std::string & name, std::size_t segment_size);
+
+	// The destructor flushes and unmaps the current segment, stops the background thread
+	// and removes the segment it prepared, if unused
+	~Journal();
+
+	// Appends a record. Returns false if the journal is not open
+	inline bool append(JournalRecordType type, const void * data, std::uint32_t size) {
+		std::size_t needed = sizeof(JournalEntry) + padded(size);
+
+		// Keep room for the end marker, roll over if the segment is full
+		if (m_offset + needed + sizeof(JournalEntry) > m_segment.size && !roll(needed))
+			return false;
+
+		JournalEntry* entry = reinterpret_cast<JournalEntry*>(m_segment.base + m_offset);
+		std::memcpy(m_segment.base + m_offset + sizeof(JournalEntry), data, size);
+		entry->size = size;
+		entry->type = type;
+		m_offset += needed;
+		++m_records;
+		return true;
+	}
+
+	// Asks the operating system to write the current segment to disk
+	void sync();
+
+	// Auxiliary features
+	bool is_open();							// False if the journal failed and is disabled
+	const std::size_t segments();			// Number of segments written so far
+	const std::size_t records();			// Number of records appended so far
+
+	// Payload sizes are padded to 8 bytes
+	static inline std::size_t padded(std::size_t size) {
+		return (size + 7) & ~(std::size_t)7;
+	}
+
+	// Path of a segment file
+	static std::string segment_path(const std::string & directory, const std::string & name, std::size_t segment);
+
+private:
+	std::string		m_directory;
+	std::string		m_name;
+	std::size_t		m_segment_size;		// Size of every segment file
+	std::size_t		m_segment_number;	// Number of the current segment
+	std::size_t		m_offset;			// Write position in the current segment
+	std::size_t		m_records;
+	MappedSegment	m_segment;
+
+	// Segment preparation, shared with the background thread under m_prepare_mt
+	std::thread					m_preparer;
+	std::mutex					m_prepare_mt;
+	std::condition_variable		m_prepare_cv;
+	MappedSegment				m_next;				// Prepared segment
+	std::size_t					m_next_number;		// Number of the segment to prepare
+	bool						m_next_pending;		// A segment is to be prepared
+	bool						m_next_ready;		// m_next is prepared (or failed, if not mapped)
+	MappedSegment				m_retired;			// Full segment to unmap
+	bool						m_stop;
+
+	// Background thread: prepares the next segment and unmaps the retired ones
+	void prepare();
+
+	// Closes the current segment and switches to the prepared one
+	bool roll(std::size_t needed);
+
+	// No copies of a journal: it owns its files
+	Journal(const Journal &);
+	Journal& operator=(const Journal &);
+};
+
+//*** JournalReader class ***//
+
+// Iterates the records of a journal, segment by segment, without copying them:
+// every JournalEntry pointer points inside the read-only mapping of its segment and
+// stays valid until the reader moves to the next segment or is destroyed.
+class JournalReader {
+public:
+	JournalReader(const std::string & directory, const std::string & name);
+	~JournalReader();
+
+	// Returns the next record, or nullptr when the journal is exhausted
+	const JournalEntry* next();
+
+private:
+	std::string		m_directory;
+	std::string		m_name;
+	std::size_t		m_segment_number;
+	std::size_t		m_offset;
+	MappedSegment	m_segment;
+
+	bool open_next();
+
+	JournalReader(const JournalReader &);
+	JournalReader& operator=(const JournalReader &);
+};
+
+#endif // !JOURNAL_HPP
@@ -0,0 +1,105 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	Testing the Journal class
+*
+*/
+
+// Import the necessary files
+#include <iostream>
+#include "Journal.hpp"
+#include "Records.hpp"
+
+int main() {
+
+	std::cout << "*** Testing Journal functionality ***\n\n";
+
+	// Journal files are written in the working directory
+	std::string directory = ".";
+
+	// Test 1: Open a journal with small segments and check it is writable
+	std::cout << "*** Test 1:\n\n";
+
+	// Room for a few records per segment, thus appending forces roll overs
+	Journal * journal = new Journal(directory, "journal_test", 512);
+
+	std::cout << "Is journal open? " << std::boolalpha << journal->is_open() << "\n";
+	std::cout << "Number of segments: " << journal->segments() << "\n\n\n";
+
+	// Success!
+
+	// Test 2: Append Order and Fill records. The segments must roll over
+	std::cout << "*** Test 2:\n\n";
+
+	std::size_t no_records = 20;
+	unsigned i = 0;
+	for (; i < no_records; ++i) {
+		if (i % 4 != 3) {
+			OrderRecord order;
+			order.sequence = i + 1;
+			order.trader_id = i + 1;
+			order.order_id = i + 1;
+			order.symbol = i % 5;
+			order.side = i % 2 == 0 ? SIDE_BUY : SIDE_SELL;
+			order.price = 10000 + 100 * i;
+			order.quantity = 10 * (i + 1);
+			order.submitted = order.timestamp = Clock::now();
+			journal->append(JOURNAL_ORDER, &order, sizeof(order));
+		}
+		else {
+			FillRecord fill;
+			fill.sequence = i;
+			fill.buyer_id = i;
+			fill.buy_order_id = i;
+			fill.seller_id = i - 1;
+			fill.sell_order_id = i - 1;
+			fill.symbol = i % 5;
+			fill.price = 10000 + 100 * i;
+			fill.quantity = 10;
+			fill.timestamp = Clock::now();
+			journal->append(JOURNAL_FILL, &fill, sizeof(fill));
+		}
+	}
+
+	std::cout << "Number of records: " << journal->records() << " (expected " << no_records << ")\n";
+	std::cout << "Number of segments: " << journal->segments() << " (expected more than 1)\n\n\n";
+
+	// Success!
+
+	// Test 3: A record bigger than a segment is refused
+	std::cout << "*** Test 3:\n\n";
+
+	char big[1024] = { 0 };
+	std::cout << "Appended a record bigger than a segment? " << journal->append(JOURNAL_ORDER, big, sizeof(big)) << "\n\n\n";
+
+	// Success!
+
+	// Test 4: Close the journal and read every record back, across the segments
+	std::cout << "*** Test 4:\n\n";
+	delete journal;
+
+	JournalReader reader(directory, "journal_test");
+	std::size_t orders = 0, fills = 0;
+	const JournalEntry * entry;
+	while ((entry = reader.next()) != nullptr) {
+		if (entry->type == JOURNAL_ORDER) {
+			const OrderRecord * order = entry->as<OrderRecord>();
+			std::cout << order->sequence << "\tORDER " << order->trader_id << " #" << order->order_id << " " << order->quantity << " @ $" << to_price(order->price, default_tick_size) << "\n";
+			++orders;
+		}
+		else if (entry->type == JOURNAL_FILL) {
+			const FillRecord * fill = entry->as<FillRecord>();
+			std::cout << fill->sequence << "\tFILL  " << fill->buyer_id << " <- " << fill->seller_id << " " << fill->quantity << " @ $" << to_price(fill->price, default_tick_size) << "\n";
+			++fills;
+		}
+	}
+
+	std::cout << "\nOrders read: " << orders << " (expected 15), Fills read: " << fills << " (expected 5)\n\n";
+
+	// Success!
+
+	return 0;
+}
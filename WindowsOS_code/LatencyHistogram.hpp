@@ -0,0 +1,149 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	LatencyHistogram definition and implementation
+*
+*/
+
+// Multiple inclusion guards to avoid linker errors
+// In case this file is included in multiple source files
+// we want to avoid re-compilations
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <cstdint>
+#include <cstring>
+
+//*** LatencyHistogram class ***//
+
+// Histogram of latencies in nanoseconds, laid out like an HDR histogram: every power of
+// two is split in the same 128 linear sub-buckets, thus every recorded value is kept
+// within 1/128 of itself (under 1% error) from 1 ns up to max_value, in a fixed array of
+// counters. Recording is a couple of shifts and an increment, with no allocation and
+// no search, thus a load generator can record every order without disturbing it.
+// A histogram belongs to one thread. Threads record in their own and merge them at the end.
+// Percentiles report the highest value of their bucket, thus they never under-state a tail
+class LatencyHistogram {
+public:
+	// Values above max_value (about 18 minutes) are counted as max_value
+	static const std::uint64_t max_value = (1ULL << 40) - 1;
+
+	// The constructor starts empty
+	LatencyHistogram() {
+		reset();
+	}
+
+	// Forgets every value
+	void reset() {
+		std::memset(m_counts, 0, sizeof(m_counts));
+		m_count = 0;
+		m_min = max_value;
+		m_max = 0;
+		m_sum = 0;
+	}
+
+	// Records a latency. Negative ones (clock noise) count as 0
+	inline void record(long long value) {
+		std::uint64_t v = value < 0 ? 0 : (std::uint64_t)value;
+		if (v > max_value)
+			v = max_value;
+
+		++m_counts[index(v)];
+		++m_count;
+		m_sum += v;
+		if (v < m_min)
+			m_min = v;
+		if (v > m_max)
+			m_max = v;
+	}
+
+	// Adds the values of another histogram
+	void merge(const LatencyHistogram & other) {
+		std::size_t i = 0;
+		for (; i < buckets; ++i)
+			m_counts[i] += other.m_counts[i];
+		m_count += other.m_count;
+		m_sum += other.m_sum;
+		if (other.m_count != 0 && other.m_min < m_min)
+			m_min = other.m_min;
+		if (other.m_max > m_max)
+			m_max = other.m_max;
+	}
+
+	// Value below which the given fraction of the values fall (0.5 is the median, 0.999
+	// the 99.9th percentile), rounded up to the end of its bucket. 0 if empty
+	std::uint64_t percentile(double fraction) const {
+		if (m_count == 0)
+			return 0;
+
+		std::uint64_t rank = (std::uint64_t)(fraction * (double)m_count + 0.5);
+		if (rank < 1)
+			rank = 1;
+		if (rank > m_count)
+			rank = m_count;
+
+		std::uint64_t seen = 0;
+		std::size_t i = 0;
+		for (; i < buckets; ++i) {
+			seen += m_counts[i];
+			if (seen >= rank)
+				break;
+		}
+
+		std::uint64_t highest = highest_value(i);
+		return highest < m_max ? highest : m_max;
+	}
+
+	inline std::uint64_t count() const { return m_count; }
+	inline std::uint64_t min() const { return m_count == 0 ? 0 : m_min; }
+	inline std::uint64_t max() const { return m_max; }
+	inline double mean() const { return m_count == 0 ? 0.0 : (double)m_sum / (double)m_count; }
+
+private:
+	// The first 256 values are exact, then every power of two [2^k, 2^(k+1)) is split in
+	// 128 buckets of width 2^(k-7), i.e. at most 1/128 (0.78%) of the values they hold
+	static const unsigned		sub_bits = 8;
+	static const std::size_t	half = 1 << (sub_bits - 1);
+	static const std::size_t	buckets = (40 - sub_bits + 2) * half;
+
+	std::uint64_t	m_counts[buckets];
+	std::uint64_t	m_count;
+	std::uint64_t	m_min;
+	std::uint64_t	m_max;
+	std::uint64_t	m_sum;
+
+	// Position of the highest set bit, by halving
+	static inline unsigned msb(std::uint64_t v) {
+		unsigned bit = 0;
+		if (v >> 32) { v >>= 32; bit += 32; }
+		if (v >> 16) { v >>= 16; bit += 16; }
+		if (v >> 8) { v >>= 8; bit += 8; }
+		if (v >> 4) { v >>= 4; bit += 4; }
+		if (v >> 2) { v >>= 2; bit += 2; }
+		if (v >> 1) { bit += 1; }
+		return bit;
+	}
+
+	static inline std::size_t index(std::uint64_t v) {
+		if (v < 2 * half)
+			return (std::size_t)v;
+
+		unsigned shift = msb(v) - (sub_bits - 1);
+		return shift * half + (std::size_t)(v >> shift);
+	}
+
+	// Highest value that lands in a bucket
+	static inline std::uint64_t highest_value(std::size_t i) {
+		if (i < 2 * half)
+			return i;
+
+		unsigned shift = (unsigned)(i / half) - 1;
+		std::uint64_t sub = i - shift * half;
+		return ((sub + 1) << shift) - 1;
+	}
+};
+
+#endif // !LATENCY_HISTOGRAM_HPP
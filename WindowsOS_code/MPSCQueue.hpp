@@ -0,0 +1,172 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	MPSCQueue definition and implementation
+*
+*/
+
+// Multiple inclusion guards to avoid linker errors
+// In case this file is included in multiple source files
+// we want to avoid re-compilations
+#ifndef MPSC_QUEUE_HPP
+#define MPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+
+//*** MPSCQueue class ***//
+
+// Bounded lock-free ring buffer for many producers (brokers submitting requests) and
+// a single consumer (the matching engine). Every slot carries a sequence number that
+// tells producers whether the slot is free and tells the consumer whether the slot
+// has been published, thus no producer ever waits on a lock held by another thread:
+//	1) A producer claims the next position with one compare-and-swap on the tail,
+//	   writes its item, and publishes the slot with a release store.
+//	2) The consumer reads the slot at its head once it is published, and hands it
+//	   back to the producers by moving its sequence one lap ahead.
+// A producer with a batch claims as many consecutive positions as are free with a single
+// compare-and-swap, thus a burst of items costs one claim instead of one per item.
+// When the ring is full push() fails immediately instead of blocking, so the caller
+// can report back-pressure. The capacity is rounded up to a power of two, so the
+// slot of a position is a mask instead of a modulo.
+// This is a template, thus the implementation lives in the header as well
+template <typename T>
+class MPSCQueue {
+public:
+	// The constructor allocates all slots upfront. There is no allocation afterwards
+	MPSCQueue(std::size_t capacity) : m_head(0) {
+		std::size_t size = 2;
+		while (size < capacity)
+			size <<= 1;
+
+		m_mask = size - 1;
+		m_slots = new Slot[size];
+
+		std::size_t i = 0;
+		for (; i < size; ++i)
+			m_slots[i].sequence.store(i, std::memory_order_relaxed);
+		m_tail.store(0, std::memory_order_relaxed);
+	}
+
+	// The destructor reclaims the slots
+	~MPSCQueue() {
+		delete[] m_slots;
+	}
+
+	// Producer side. Returns false if the ring is full
+	inline bool push(const T & item) {
+		std::size_t pos = m_tail.load(std::memory_order_relaxed);
+		Slot* slot;
+
+		for (;;) {
+			slot = &m_slots[pos & m_mask];
+			std::size_t seq = slot->sequence.load(std::memory_order_acquire);
+			std::ptrdiff_t diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)pos;
+
+			// The slot is free: try to claim the position
+			if (diff == 0) {
+				if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			// The consumer hasn't released the slot yet: the ring is full
+			else if (diff < 0)
+				return false;
+			// Another producer claimed the position first: reload the tail
+			else
+				pos = m_tail.load(std::memory_order_relaxed);
+		}
+
+		slot->item = item;
+		slot->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Producer side, for a batch. Claims up to count consecutive positions at once and
+	// publishes the items in order. Returns the number of items pushed: fewer than count
+	// if the ring fills up, 0 if it is full
+	inline std::size_t push(const T * items, std::size_t count) {
+		if (count == 0)
+			return 0;
+
+		std::size_t pos = m_tail.load(std::memory_order_relaxed);
+		std::size_t n;
+
+		for (;;) {
+			// Count the free slots from the tail on. The consumer releases the slots
+			// in order, thus the free ones are consecutive
+			n = 0;
+			while (n < count && m_slots[(pos + n) & m_mask].sequence.load(std::memory_order_acquire) == pos + n)
+				++n;
+
+			if (n != 0) {
+				if (m_tail.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed))
+					break;
+				continue;
+			}
+
+			// No free slot at the tail: either the ring is full, or another producer
+			// claimed the position first and the tail must be reloaded
+			std::size_t seq = m_slots[pos & m_mask].sequence.load(std::memory_order_acquire);
+			if ((std::ptrdiff_t)seq - (std::ptrdiff_t)pos < 0)
+				return 0;
+			pos = m_tail.load(std::memory_order_relaxed);
+		}
+
+		std::size_t i = 0;
+		for (; i < n; ++i) {
+			Slot* slot = &m_slots[(pos + i) & m_mask];
+			slot->item = items[i];
+			slot->sequence.store(pos + i + 1, std::memory_order_release);
+		}
+		return n;
+	}
+
+	// Consumer side. Only the matching engine calls it. Returns false if the ring is empty
+	inline bool pop(T & item) {
+		Slot* slot = &m_slots[m_head & m_mask];
+		if (slot->sequence.load(std::memory_order_acquire) != m_head + 1)
+			return false;
+
+		item = slot->item;
+		slot->sequence.store(m_head + m_mask + 1, std::memory_order_release);
+		++m_head;
+		return true;
+	}
+
+	// Consumer side. Returns true if there is no published item at the head
+	inline bool empty() {
+		return m_slots[m_head & m_mask].sequence.load(std::memory_order_acquire) != m_head + 1;
+	}
+
+	// Number of slots in the ring
+	const std::size_t capacity() {
+		return m_mask + 1;
+	}
+
+	// Number of positions claimed by producers since the ring was created
+	const std::size_t claimed() {
+		return m_tail.load(std::memory_order_acquire);
+	}
+
+private:
+	struct Slot {
+		std::atomic<std::size_t>	sequence;
+		T							item;
+	};
+
+	Slot*						m_slots;	// The ring
+	std::size_t					m_mask;		// Capacity - 1
+
+	// Producers and consumer write different cache lines
+	alignas(64) std::atomic<std::size_t>	m_tail;		// Next position to claim (producers)
+	alignas(64) std::size_t					m_head;		// Next position to read (consumer)
+
+	// No copies of the ring
+	MPSCQueue(const MPSCQueue &);
+	MPSCQueue& operator=(const MPSCQueue &);
+};
+
+#endif // !MPSC_QUEUE_HPP
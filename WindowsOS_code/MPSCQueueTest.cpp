@@ -0,0 +1,142 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	Testing the MPSCQueue class
+*
+*/
+
+// Import the necessary files
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "MPSCQueue.hpp"
+
+int main() {
+
+	std::cout << "*** Testing MPSCQueue functionality ***\n\n";
+
+	// Test 1: The capacity is rounded up to a power of two. A new ring is empty
+	std::cout << "*** Test 1:\n\n";
+	MPSCQueue<int> ring(5);
+
+	int item = 0;
+	std::cout << "Capacity: " << ring.capacity() << " (expected 8)\n";
+	std::cout << "Is ring empty? " << std::boolalpha << ring.empty() << " (expected true)\n";
+	std::cout << "Pop from an empty ring: " << ring.pop(item) << " (expected false)\n\n\n";
+
+	// Success!
+
+	// Test 2: Fill the ring. The push after the last free slot fails instead of blocking,
+	// and a pop frees exactly one slot
+	std::cout << "*** Test 2:\n\n";
+
+	int i = 0;
+	for (; i < 8; ++i)
+		ring.push(i);
+	std::cout << "Push into a full ring: " << ring.push(8) << " (expected false)\n";
+
+	ring.pop(item);
+	std::cout << "Popped: " << item << " (expected 0)\n";
+	std::cout << "Push after one pop: " << ring.push(8) << " (expected true)\n";
+	std::cout << "Push into a full ring again: " << ring.push(9) << " (expected false)\n\n\n";
+
+	// Success!
+
+	// Test 3: Wrap around. Laps of pushes and pops keep the items in order across the end
+	// of the slot array
+	std::cout << "*** Test 3:\n\n";
+
+	bool ordered = true;
+	int expected = 1, next = 9;
+	int lap = 0;
+	for (; lap < 5; ++lap) {
+		for (i = 0; i < 5; ++i) {
+			ring.pop(item);
+			if (item != expected++)
+				ordered = false;
+		}
+		for (i = 0; i < 5; ++i)
+			ring.push(next++);
+	}
+	while (ring.pop(item))
+		if (item != expected++)
+			ordered = false;
+
+	std::cout << "Items in order over 5 laps: " << ordered << " (expected true)\n";
+	std::cout << "Last item: " << item << " (expected " << next - 1 << ")\n";
+	std::cout << "Positions claimed: " << ring.claimed() << " (expected " << next << ")\n\n\n";
+
+	// Success!
+
+	// Test 4: Batch push. A batch takes the free slots it finds and reports how many,
+	// the rest of the batch is left to the caller
+	std::cout << "*** Test 4:\n\n";
+	MPSCQueue<int> batch_ring(8);
+
+	int batch[6] = { 10, 11, 12, 13, 14, 15 };
+	std::cout << "Pushed of a batch of 6: " << batch_ring.push(batch, 6) << " (expected 6)\n";
+	std::cout << "Pushed of a second batch of 6: " << batch_ring.push(batch, 6) << " (expected 2)\n";
+	std::cout << "Pushed of a batch into a full ring: " << batch_ring.push(batch, 6) << " (expected 0)\n";
+
+	ordered = true;
+	int popped[8];
+	for (i = 0; i < 8; ++i)
+		batch_ring.pop(popped[i]);
+	for (i = 0; i < 6; ++i)
+		if (popped[i] != batch[i])
+			ordered = false;
+	std::cout << "Batches in order: " << (ordered && popped[6] == 10 && popped[7] == 11) << " (expected true)\n\n\n";
+
+	// Success!
+
+	// Test 5: Several producers, single and batched pushes, and one consumer. Every item
+	// arrives once, and the items of each producer arrive in the order it pushed them
+	std::cout << "*** Test 5:\n\n";
+	MPSCQueue<long> shared(64);
+
+	const long producers = 4, per_producer = 20000;
+	std::vector<std::thread> threads;
+	long p = 0;
+	for (; p < producers; ++p)
+		threads.push_back(std::thread([&shared, p, per_producer]() {
+			long k = 0;
+			while (k < per_producer) {
+				if (k % 2 == 0) {
+					long pair[2] = { p * per_producer + k, p * per_producer + k + 1 };
+					k += (long)shared.push(pair, k + 1 < per_producer ? 2 : 1);
+				}
+				else if (shared.push(p * per_producer + k))
+					++k;
+				else
+					std::this_thread::yield();
+			}
+		}));
+
+	std::vector<long> last(producers, -1);
+	long received = 0, value = 0;
+	ordered = true;
+	while (received < producers * per_producer) {
+		if (!shared.pop(value)) {
+			std::this_thread::yield();
+			continue;
+		}
+		long from = value / per_producer;
+		if (value % per_producer != last[from] + 1)
+			ordered = false;
+		last[from] = value % per_producer;
+		++received;
+	}
+	for (p = 0; p < producers; ++p)
+		threads[p].join();
+
+	std::cout << "Received: " << received << " (expected " << producers * per_producer << ")\n";
+	std::cout << "Every producer in order: " << ordered << " (expected true)\n";
+	std::cout << "Ring empty at the end: " << shared.empty() << " (expected true)\n\n\n";
+
+	// Success!
+
+	return 0;
+}
@@ -0,0 +1,143 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	Market data snapshots and SeqLock definition and implementation
+*
+*/
+
+// Multiple inclusion guards to avoid linker errors
+// In case this file is included in multiple source files
+// we want to avoid re-compilations
+#ifndef MARKET_DATA_HPP
+#define MARKET_DATA_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "FixedPoint.hpp"
+
+//*** Snapshots ***//
+
+// Price levels published per side of a book
+static const std::size_t book_depth = 10;
+
+// One aggregated price level. An empty level has no quantity
+struct BookLevel {
+	Ticks			price;			// In ticks of the stock
+	long long		quantity;		// Aggregate resting quantity
+	long long		orders;			// Number of resting orders
+};
+
+// Best bid and offer of a stock. A side with no order has a quantity of 0
+struct Quote {
+	std::uint64_t	sequence;		// Engine sequence number of the last message behind the quote
+	long long		timestamp;		// Nanoseconds since epoch, at publication (Clock)
+	Cash			tick_size;		// Converts the prices to dollars (see to_price)
+	std::uint32_t	symbol;			// Index of the stock in the Exchange
+	std::uint32_t	trading;		// 0 once the stock is halted
+	BookLevel		bid;
+	BookLevel		ask;
+};
+
+// Top book_depth levels of each side of a stock, best first. Levels past
+// bid_levels and ask_levels are empty
+struct BookDepth {
+	std::uint64_t	sequence;		// Engine sequence number of the last message behind the book
+	long long		timestamp;		// Nanoseconds since epoch, at publication (Clock)
+	Cash			tick_size;		// Converts the prices to dollars (see to_price)
+	std::uint32_t	symbol;			// Index of the stock in the Exchange
+	std::uint32_t	trading;		// 0 once the stock is halted
+	std::uint32_t	bid_levels;		// Levels filled in bids
+	std::uint32_t	ask_levels;		// Levels filled in asks
+	BookLevel		bids[book_depth];
+	BookLevel		asks[book_depth];
+};
+
+//*** SeqLock class ***//
+
+// Single-writer, many-reader snapshot of a plain struct. The writer never waits for the
+// readers: it bumps the version to odd, copies the new value in and bumps the version
+// to even. A reader copies the value out between two reads of the version, and retries if
+// the version was odd or moved, i.e. if a write overlapped. Readers write nothing, thus
+// any number of them can poll the snapshot without contending with each other or
+// slowing the writer down.
+// The value is kept in 64-bit atomic words, copied with relaxed loads and stores, thus a
+// torn read is detected and discarded, never undefined behaviour.
+// This is a template, thus the implementation lives in the header as well
+template <typename T>
+class SeqLock {
+	static_assert(std::is_trivially_copyable<T>::value, "A SeqLock holds plain data only");
+
+public:
+	// The constructor publishes a zeroed value
+	SeqLock() : m_version(0) {
+		std::size_t i = 0;
+		for (; i < words; ++i)
+			m_data[i].store(0, std::memory_order_relaxed);
+	}
+
+	// Publishes a value. One writer at a time
+	inline void write(const T & value) {
+		std::uint64_t buffer[words] = {};
+		std::memcpy(buffer, &value, sizeof(T));
+
+		std::uint64_t version = m_version.load(std::memory_order_relaxed);
+		m_version.store(version + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		std::size_t i = 0;
+		for (; i < words; ++i)
+			m_data[i].store(buffer[i], std::memory_order_relaxed);
+
+		m_version.store(version + 2, std::memory_order_release);
+	}
+
+	// Copies the value out. Returns false if a write overlapped, the copy is then unusable
+	inline bool try_read(T & value) const {
+		std::uint64_t before = m_version.load(std::memory_order_acquire);
+		if (before & 1)
+			return false;
+
+		std::uint64_t buffer[words];
+		std::size_t i = 0;
+		for (; i < words; ++i)
+			buffer[i] = m_data[i].load(std::memory_order_relaxed);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (m_version.load(std::memory_order_relaxed) != before)
+			return false;
+
+		std::memcpy(&value, buffer, sizeof(T));
+		return true;
+	}
+
+	// Copies the value out, retrying until no write overlaps. Writes are short, thus
+	// a retry is rare and brief
+	inline T read() const {
+		T value;
+		while (!try_read(value)) {}
+		return value;
+	}
+
+	// Number of values published so far
+	inline std::uint64_t version() const {
+		return m_version.load(std::memory_order_acquire) / 2;
+	}
+
+private:
+	static const std::size_t words = (sizeof(T) + 7) / 8;
+
+	alignas(64) std::atomic<std::uint64_t>	m_version;		// Odd while a write is in progress
+	std::atomic<std::uint64_t>				m_data[words];
+
+	// No copies of a snapshot: readers hold a pointer to it
+	SeqLock(const SeqLock &);
+	SeqLock& operator=(const SeqLock &);
+};
+
+#endif // !MARKET_DATA_HPP
@@ -0,0 +1,118 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	Testing the SeqLock class and the market data of the Exchange
+*
+*/
+
+// Import the necessary files
+#include <iostream>
+#include <thread>
+#include "Exchange.hpp"
+
+// Snapshot whose words are all written with the same value, thus a copy that mixes
+// two writes shows up as words that differ
+struct Counters {
+	std::uint64_t	words[16];
+};
+
+int main() {
+
+	std::cout << "*** Testing market data functionality ***\n\n";
+	std::cout << std::boolalpha;
+
+	// Test 1: A new SeqLock holds a zeroed value. Every write publishes a new version
+	std::cout << "*** Test 1:\n\n";
+	SeqLock<Counters> lock;
+
+	Counters value;
+	std::cout << "Read a new snapshot: " << (lock.try_read(value) && value.words[0] == 0 && value.words[15] == 0) << " (expected true)\n";
+
+	std::size_t i = 0;
+	for (i = 0; i < 16; ++i)
+		value.words[i] = 7;
+	lock.write(value);
+	lock.write(value);
+	std::cout << "Version after 2 writes: " << lock.version() << " (expected 2)\n";
+	std::cout << "Last word read: " << lock.read().words[15] << " (expected 7)\n\n\n";
+
+	// Success!
+
+	// Test 2: A writer publishes without pause while a reader polls. Reads that overlap a
+	// write in flight fail and are retried, and no read ever returns a mix of two writes
+	std::cout << "*** Test 2:\n\n";
+
+	std::atomic<bool> done(false);
+	std::thread writer([&lock, &done]() {
+		Counters next;
+		std::uint64_t n = 8;
+		while (!done.load(std::memory_order_relaxed)) {
+			std::size_t w = 0;
+			for (; w < 16; ++w)
+				next.words[w] = n;
+			lock.write(next);
+			++n;
+		}
+	});
+
+	// Poll until some reads were retried, a few seconds at most
+	long long reads = 0, retries = 0, torn = 0;
+	std::uint64_t last = 0;
+	bool monotonic = true;
+	long long deadline = Clock::now() + 5000000000LL;
+	while ((retries < 100 || reads < 100000) && Clock::now() < deadline) {
+		if (!lock.try_read(value)) {
+			++retries;
+			continue;
+		}
+		++reads;
+		for (i = 1; i < 16; ++i)
+			if (value.words[i] != value.words[0])
+				++torn;
+		if (value.words[0] < last)
+			monotonic = false;
+		last = value.words[0];
+	}
+	done = true;
+	writer.join();
+
+	std::cout << "Reads retried while a write was in flight: " << (retries > 0) << " (expected true)\n";
+	std::cout << "Torn reads returned: " << torn << " (expected 0)\n";
+	std::cout << "Values never went back: " << monotonic << " (expected true)\n\n\n";
+
+	// Success!
+
+	// Test 3: The Exchange publishes the best bid and offer and the depth of a stock after
+	// its engine applies the orders
+	std::cout << "*** Test 3:\n\n";
+	{
+		Exchange NYSE;
+		Trader maker(1'000'000);
+
+		AutoRequest bid1("BUY", "TSLA", 99.0, 10), bid2("BUY", "TSLA", 99.0, 5), bid3("BUY", "TSLA", 98.0, 7);
+		AutoRequest ask("SELL", "TSLA", 101.0, 3);
+		NYSE.submit_trade(TradeNode(&maker, &bid1));
+		NYSE.submit_trade(TradeNode(&maker, &bid2));
+		NYSE.submit_trade(TradeNode(&maker, &bid3));
+		NYSE.submit_trade(TradeNode(&maker, &ask));
+		NYSE.flush();
+
+		Quote quote;
+		BookDepth depth;
+		bool listed = NYSE.get_quote("TSLA", quote) && NYSE.get_depth("TSLA", depth);
+		bool unknown = NYSE.get_quote("NVDA", quote);
+		std::cout << "Known stock: " << listed << ", unknown stock: " << unknown << " (expected true, false)\n";
+		std::cout << "Best bid: " << to_price(quote.bid.price, quote.tick_size) << " x " << quote.bid.quantity << " in " << quote.bid.orders
+			<< " orders, best ask: " << to_price(quote.ask.price, quote.tick_size) << " x " << quote.ask.quantity
+			<< " (expected 99 x 15 in 2 orders, 101 x 3)\n";
+		std::cout << "Bid levels: " << depth.bid_levels << ", second: " << to_price(depth.bids[1].price, depth.tick_size) << " x " << depth.bids[1].quantity
+			<< ", ask levels: " << depth.ask_levels << " (expected 2, 98 x 7, 1)\n\n\n";
+	}
+
+	// Success!
+
+	return 0;
+}
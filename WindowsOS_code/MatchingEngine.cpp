@@ -0,0 +1,673 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  =================================================
+*
+*	MatchingEngine class implementation
+*
+*/
+
+#include "MatchingEngine.hpp"
+
+#include <limits>
+
+//*** Constructor, Destructor, and thread control ***//
+
+// Number of empty passes the engine spins before it yields or parks
+static const unsigned spin_passes = 1000;
+
+// Messages the engine applies at most before it publishes the market data of a busy ring
+static const std::size_t publish_interval = 256;
+
+// The constructor creates an idle engine with no instruments and allocates its ingress ring
+MatchingEngine::MatchingEngine(std::size_t ring_capacity, WaitStrategy wait, std::size_t order_capacity,
+	std::size_t level_capacity, std::size_t ladder_levels, Journal * journal, bool run_to_completion, bool market_data)
+	: m_sequence(0), m_entry_pool(order_capacity), m_level_pool(level_capacity), m_orders(order_capacity),
+	m_ladder_levels(ladder_levels), ingress(ring_capacity), running(false), applied(0), m_wait(wait), sleeping(false),
+	m_inline(run_to_completion), owner(false), m_market_data(market_data), m_journal(journal) {
+
+	// The books are logs and keep growing, but a day within the pool size doesn't reallocate them
+	OrderBook.reserve(order_capacity);
+	FillBook.reserve(order_capacity);
+}
+
+// The destructor makes sure the matching thread has finished before the
+// engine and its instruments go away. The journal is closed last, after the final drain
+MatchingEngine::~MatchingEngine() {
+	stop();
+	delete m_journal;
+}
+
+// Pins an instrument to this engine. From now on only this engine touches its ladders,
+// and they take their entries and levels from the engine's pools. Its empty book is
+// published right away, thus readers find the stock's tick size before the first order
+void MatchingEngine::pin(ExchangeNode * node) {
+	node->bids.attach(&m_entry_pool, &m_level_pool, m_ladder_levels);
+	node->asks.attach(&m_entry_pool, &m_level_pool, m_ladder_levels);
+	m_nodes.push_back(node);
+	m_touched.reserve(m_nodes.size());
+	if (m_market_data)
+		publish(*node);
+}
+
+// Launches the matching engine on the background
+// It runs parallely, letting the brokers/traders to submit requests at all times
+// This might be a little expensive for the CPU but will certainly payoff for high volumes
+// of incoming requests
+// In run-to-completion mode there is no thread to launch
+void MatchingEngine::start() {
+	running = true;
+	if (!m_inline)
+		ignite = std::thread{ &MatchingEngine::matching_engine, this };
+}
+
+// Stops the engine and waits for its thread to finish, thus preventing a crash
+// when the Exchange de-allocates the instruments
+void MatchingEngine::stop() {
+	running = false;
+	wake();
+	if (ignite.joinable())
+		ignite.join();
+
+	// Brokers drained their own messages, but one may have left its message to a
+	// thread that was finishing at the time
+	if (m_inline)
+		run();
+}
+
+//*** Matching Engine Implementation ***//
+
+// The matching engine will run in the background as long as the
+// exchange is open, and will constantly be checking for available trades
+// in the instruments pinned to it. Every pass applies the messages waiting
+// in the ingress ring, thus the ladders have a single owner and need no lock,
+// and fills what each message crosses as it is applied.
+// A pass that applies nothing is idle, and the engine waits as per its
+// wait strategy before the next one
+void MatchingEngine::matching_engine() {
+	unsigned idle_passes = 0;
+
+	// While the exchange is open ...
+	while (running.load(std::memory_order_acquire)) {
+
+		// ... sequence, apply and match the new submissions, edits and deletes
+		std::size_t count = drain();
+
+		if (count != 0) {
+			applied.fetch_add(count, std::memory_order_release);
+			idle_passes = 0;
+		}
+		else
+			idle(idle_passes);
+	}
+
+	// Requests that made it into the ring before closing still reach the books
+	applied.fetch_add(drain(), std::memory_order_release);
+}
+
+// Fills an instrument until its top of the book no longer crosses.
+// Returns true if at least one trade was executed
+bool MatchingEngine::match(ExchangeNode & node) {
+	bool matched = false;
+	if (!node.trading)
+		return matched;
+
+	for (;;) {
+
+		// If there are trades to be executed, the top of each side is O(1) ...
+		OrderEntry* buy_order = node.bids.front();
+		OrderEntry* sell_order = node.asks.front();
+
+		if (buy_order == nullptr || sell_order == nullptr)
+			return matched;
+
+		// ... check the prices of SELL and BUY orders to see if the trade is possible.
+		if (buy_order->order.price < sell_order->order.price)
+			return matched;
+
+		execute(node, buy_order, sell_order);
+		matched = true;
+	}
+}
+
+// Applies every message waiting in the ingress ring, in arrival order.
+// This is the sequencer: each message gets the next sequence number of the engine
+// before it reaches a book. The stocks the messages changed are published once the
+// ring is empty, or every publish_interval messages if it never empties.
+// Returns the number of messages applied
+std::size_t MatchingEngine::drain() {
+	std::size_t count = 0;
+	OrderMessage msg;
+	while (ingress.pop(msg)) {
+		msg.order.sequence = ++m_sequence;
+		if (msg.type != OrderMessage::SUBMIT)
+			journal(msg);
+
+		switch (msg.type) {
+		case OrderMessage::SUBMIT:
+			submit(*msg.node, msg.order);
+			break;
+		case OrderMessage::EDIT_PRICE:
+			edit_price(*msg.node, msg.order);
+			break;
+		case OrderMessage::EDIT_QUANTITY:
+			edit_quantity(*msg.node, msg.order);
+			break;
+		case OrderMessage::DELETE:
+			remove(*msg.node, msg.order);
+			break;
+		case OrderMessage::LIST:
+			pin(msg.node);
+			break;
+		case OrderMessage::HALT:
+			halt(*msg.node);
+			break;
+		}
+		++count;
+
+		if (m_market_data) {
+			msg.node->last_sequence = msg.order.sequence;
+			if (!msg.node->touched) {
+				msg.node->touched = true;
+				m_touched.push_back(msg.node);
+			}
+			if (count % publish_interval == 0)
+				publish();
+		}
+	}
+
+	if (m_market_data)
+		publish();
+	return count;
+}
+
+// Publishes the stocks changed since the last publication, once each however many
+// messages changed them
+void MatchingEngine::publish() {
+	std::size_t i = 0;
+	for (; i < m_touched.size(); ++i) {
+		m_touched[i]->touched = false;
+		publish(*m_touched[i]);
+	}
+	m_touched.clear();
+}
+
+// Walks the top levels of both sides, best first, and writes the two snapshots of the stock.
+// The levels carry their aggregates, thus the walk reads one level per price and never
+// visits an order
+void MatchingEngine::publish(ExchangeNode & node) {
+	BookDepth book = {};
+	book.sequence = node.last_sequence;
+	book.timestamp = Clock::now();
+	book.tick_size = node.tick_size;
+	book.symbol = node.id;
+	book.trading = node.trading ? 1 : 0;
+
+	PriceLevel* level = node.bids.best();
+	for (; level != nullptr && book.bid_levels < book_depth; level = level->worse) {
+		BookLevel & out = book.bids[book.bid_levels++];
+		out.price = level->price;
+		out.quantity = level->quantity;
+		out.orders = (long long)level->count;
+	}
+
+	level = node.asks.best();
+	for (; level != nullptr && book.ask_levels < book_depth; level = level->worse) {
+		BookLevel & out = book.asks[book.ask_levels++];
+		out.price = level->price;
+		out.quantity = level->quantity;
+		out.orders = (long long)level->count;
+	}
+
+	Quote quote = {};
+	quote.sequence = book.sequence;
+	quote.timestamp = book.timestamp;
+	quote.tick_size = book.tick_size;
+	quote.symbol = book.symbol;
+	quote.trading = book.trading;
+	quote.bid = book.bids[0];
+	quote.ask = book.asks[0];
+
+	node.quote.write(quote);
+	node.depth.write(book);
+}
+
+// Every claimed position of the ring is eventually published, applied and matched once,
+// thus waiting for the applied count to reach the claimed count is enough
+void MatchingEngine::flush() {
+	std::size_t target = ingress.claimed();
+	while (applied.load(std::memory_order_acquire) < target && running.load(std::memory_order_acquire)) {
+		if (m_inline)
+			run();
+		std::this_thread::yield();
+	}
+}
+
+// Run to completion: the calling thread takes ownership of the books, drains the ring
+// and hands ownership back. A thread that finds the books owned leaves its message to
+// the owner. The owner checks the ring once more after handing ownership back, and the
+// fences make sure that either the owner sees the message or the broker sees the books
+// free, thus no message is stranded in the ring
+void MatchingEngine::run() {
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	do {
+		if (owner.exchange(true, std::memory_order_acquire))
+			return;
+
+		std::size_t count = drain();
+		if (count != 0)
+			applied.fetch_add(count, std::memory_order_release);
+
+		owner.store(false, std::memory_order_release);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+	} while (applied.load(std::memory_order_acquire) < ingress.claimed());
+}
+
+// Executes a crossed pair of resting orders. The trade happens at the price of the order
+// that was resting first (the lower sequence number), for the smaller of the two quantities
+void MatchingEngine::execute(ExchangeNode & node, OrderEntry * buy_order, OrderEntry * sell_order) {
+
+	const Order & buyer = buy_order->order;
+	const Order & seller = sell_order->order;
+
+	Ticks trade_price = buyer.sequence < seller.sequence ? buyer.price : seller.price;
+
+	// Get quantities. Whoever wants less is completely filled
+	long long fill_quant = buyer.quantity < seller.quantity ? buyer.quantity : seller.quantity;
+	settle(node, buyer, seller, trade_price, fill_quant);
+
+	// Remove the filled quantities. Completely filled orders leave the ladders and the index.
+	// The ids are copied first, since a completely filled entry is reclaimed
+	std::uint64_t buy_id = buyer.id, sell_id = seller.id;
+	if (node.bids.fill(buy_order, fill_quant))
+		m_orders.erase(buy_id);
+	if (node.asks.fill(sell_order, fill_quant))
+		m_orders.erase(sell_id);
+
+	// Update ExchangeNode as per the availability there
+	if (node.bids.empty() && node.asks.empty())
+		node.available.store(false, std::memory_order_relaxed);
+}
+
+// Matches an incoming order as a taker. It sweeps the opposite side best level first,
+// filling at the price of each resting order, until it is filled or it no longer crosses.
+// The order never enters the book for the part that fills.
+// A market order has no limit to reserve against on submission, thus it reserves each
+// fill as it goes, and stops where the trader can no longer cover one
+void MatchingEngine::take(ExchangeNode & node, Order & taker) {
+	if (!node.trading)
+		return;
+
+	PriceLadder & book = taker.side == SIDE_BUY ? node.asks : node.bids;
+	while (taker.quantity > 0) {
+		OrderEntry* maker = book.front();
+		if (maker == nullptr)
+			return;
+		if (taker.side == SIDE_BUY ? taker.price < maker->order.price : taker.price > maker->order.price)
+			return;
+
+		long long fill_quant = taker.quantity < maker->order.quantity ? taker.quantity : maker->order.quantity;
+		if (taker.type == ORDER_MARKET && !taker.trader->reserve(notional(maker->order.price, node.tick_size, fill_quant)))
+			return;
+
+		if (taker.side == SIDE_BUY)
+			settle(node, taker, maker->order, maker->order.price, fill_quant);
+		else
+			settle(node, maker->order, taker, maker->order.price, fill_quant);
+
+		taker.quantity -= fill_quant;
+		std::uint64_t maker_id = maker->order.id;
+		if (book.fill(maker, fill_quant))
+			m_orders.erase(maker_id);
+	}
+}
+
+// Settles a trade, reports it to both traders and logs it in the Fill book.
+// Prices are ticks and the notional is settled in minor units, thus the traders'
+// accounts only see exact integer amounts. Both orders reserved their notional when
+// they were submitted (a market order, right before the fill), thus the settlement
+// is two atomic updates per account and can't fail.
+// The quantities of the orders are the ones before the fill
+void MatchingEngine::settle(ExchangeNode & node, const Order & buyer, const Order & seller, Ticks trade_price, long long fill_quant) {
+	Cash trade_value = notional(trade_price, node.tick_size, fill_quant);
+
+	// Every order reserved at its limit price, and a market order at the trade price
+	Cash buyer_reserved = buyer.type == ORDER_MARKET ? trade_value : reservation(buyer, node.tick_size, fill_quant);
+	Cash seller_reserved = seller.type == ORDER_MARKET ? trade_value : reservation(seller, node.tick_size, fill_quant);
+	buyer.trader->settle_buy(trade_value, buyer_reserved);
+	seller.trader->settle_sell(trade_value, seller_reserved);
+
+	long long buyer_leaves = buyer.quantity - fill_quant, seller_leaves = seller.quantity - fill_quant;
+	report(node, buyer, buyer_leaves == 0 ? REPORT_FILL : REPORT_PARTIAL_FILL, trade_price, fill_quant, buyer_leaves);
+	report(node, seller, seller_leaves == 0 ? REPORT_FILL : REPORT_PARTIAL_FILL, trade_price, fill_quant, seller_leaves);
+
+	// Update the Fill book
+	FillRecord record;
+	record.sequence = m_sequence;
+	record.buyer_id = buyer.trader->getId();
+	record.buy_order_id = buyer.id;
+	record.seller_id = seller.trader->getId();
+	record.sell_order_id = seller.id;
+	record.symbol = node.id;
+	record.price = trade_price;
+	record.quantity = fill_quant;
+	record.timestamp = Clock::now();
+
+	std::unique_lock<std::mutex> lock(books_mt);
+	FillBook.push_back(record);
+	lock.unlock();
+
+	if (m_journal != nullptr)
+		m_journal->append(JOURNAL_FILL, &record, sizeof(record));
+}
+
+// Builds the report of an event on an order. Traders that didn't subscribe cost one load
+void MatchingEngine::report(ExchangeNode & node, const Order & order, ReportType type, Ticks price, long long quantity,
+	long long leaves, RejectReason reason) {
+	ExecutionReports* reports = order.trader->subscription();
+	if (reports == nullptr)
+		return;
+
+	ExecutionReport r;
+	r.order_id = order.id;
+	r.sequence = m_sequence;
+	r.timestamp = Clock::now();
+	r.price = price;
+	r.quantity = quantity;
+	r.leaves = leaves;
+	r.tick_size = node.tick_size;
+	r.symbol = node.id;
+	r.side = order.side;
+	r.type = type;
+	r.reason = reason;
+	reports->push(r);
+}
+
+//*** Wait strategies ***//
+
+// Called after an idle pass. Spins for a while in all strategies, since new flow
+// usually arrives in bursts, then yields or parks as per the strategy
+void MatchingEngine::idle(unsigned & idle_passes) {
+	if (m_wait == BUSY_SPIN || ++idle_passes < spin_passes) {
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+		_mm_pause();
+#endif
+		return;
+	}
+
+	if (m_wait == SPIN_YIELD) {
+		std::this_thread::yield();
+		return;
+	}
+
+	// BLOCKING: announce that the engine parks, then check the ring once more.
+	// A broker that enqueued before the announcement is seen here, and a broker
+	// that enqueues after it sees the flag and wakes the engine up
+	std::unique_lock<std::mutex> lock(wait_mt);
+	sleeping.store(true, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	wait_cv.wait(lock, [this] { return !ingress.empty() || !running.load(std::memory_order_acquire); });
+	sleeping.store(false, std::memory_order_relaxed);
+	idle_passes = 0;
+}
+
+// Wakes a parked engine up. Taking the lock guarantees the engine is either
+// still checking the ring or already waiting, thus the notification is never lost
+void MatchingEngine::wake() {
+	std::unique_lock<std::mutex> lock(wait_mt);
+	wait_cv.notify_one();
+}
+
+//*** Message handlers ***//
+
+// Logs an order in the Order book, matches it against the opposite side, and
+// rests what is left of it in the ladder of its side. Only limit orders rest: what is
+// left of an IOC or a market order is cancelled, and a fill-or-kill order that the
+// book can't fill completely is cancelled before it trades. A cancelled remainder gives
+// its reservation back to the trader and is reported as a cancel.
+// The halt check at the door races with the halt itself: an order that passed it can
+// reach the engine after the HALT message. It is logged like every message the engine
+// sequenced, then rejected, and never rests in the halted book
+void MatchingEngine::submit(ExchangeNode & node, const Order & order) {
+	Order taker = order;
+	taker.timestamp = Clock::now();
+	updateOrderBook(taker);
+
+	if (!node.trading) {
+		taker.trader->release(reservation(taker, node.tick_size, taker.quantity));
+		report(node, taker, REPORT_REJECT, 0, 0, 0, REJECT_HALTED);
+		return;
+	}
+
+	// A market order takes any price: its limit is the far end of the opposite side
+	if (taker.type == ORDER_MARKET)
+		taker.price = taker.side == SIDE_BUY ? std::numeric_limits<Ticks>::max() : std::numeric_limits<Ticks>::min();
+
+	if (taker.type == ORDER_FOK && !fillable(node, taker)) {
+		taker.trader->release(reservation(taker, node.tick_size, taker.quantity));
+		report(node, taker, REPORT_CANCEL_ACK, 0, taker.quantity, 0);
+		return;
+	}
+
+	take(node, taker);
+
+	if (taker.quantity > 0 && taker.type == ORDER_LIMIT) {
+		PriceLadder & ladder = taker.side == SIDE_BUY ? node.bids : node.asks;
+		m_orders.insert(taker.id, ladder.push(taker));
+	}
+	else if (taker.quantity > 0) {
+		taker.trader->release(reservation(taker, node.tick_size, taker.quantity));
+		report(node, taker, REPORT_CANCEL_ACK, 0, taker.quantity, 0);
+	}
+	node.available.store(!node.bids.empty() || !node.asks.empty(), std::memory_order_relaxed);
+}
+
+// Checks that the opposite side holds the whole quantity of an order within its limit.
+// The level aggregates give the answer in one read per level
+bool MatchingEngine::fillable(ExchangeNode & node, const Order & taker) {
+	if (!node.trading)
+		return false;
+
+	PriceLadder & book = taker.side == SIDE_BUY ? node.asks : node.bids;
+	return book.depth(taker.price, taker.quantity) >= taker.quantity;
+}
+
+// Resting entry lookup in O(1). The entry must belong to the trader and rest on the
+// requested stock and side, otherwise the modification is ignored
+OrderEntry* MatchingEngine::find_order(ExchangeNode & node, const Order & edit) {
+	OrderEntry** found = m_orders.find(edit.id);
+	if (found == nullptr)
+		return nullptr;
+
+	OrderEntry* entry = *found;
+	if (entry->order.trader != edit.trader || entry->order.side != edit.side || entry->order.symbol != node.id)
+		return nullptr;
+	return entry;
+}
+
+// Editing an existing trade -- change the price
+// The order loses its time priority: it takes the sequence number of the edit
+// and joins the back of its new price level.
+// The reservation follows the new price. If the trader can't cover a higher
+// notional, the edit is ignored and the order keeps its price.
+// Ignored edits are reported as rejects, and so are the edits that reach a halted stock
+void MatchingEngine::edit_price(ExchangeNode & node, const Order & edit) {
+	if (!node.trading) {
+		report(node, edit, REPORT_REJECT, 0, 0, 0, REJECT_HALTED);
+		return;
+	}
+
+	OrderEntry* entry = find_order(node, edit);
+	if (entry == nullptr) {
+		report(node, edit, REPORT_REJECT, 0, 0, 0, REJECT_UNKNOWN_ORDER);
+		return;
+	}
+
+	Order order = entry->order;
+	Cash held = reservation(order, node.tick_size, order.quantity);
+	Cash needed = notional(edit.price, node.tick_size, order.quantity);
+	if (needed > held && !order.trader->reserve(needed - held)) {
+		report(node, order, REPORT_REJECT, 0, 0, order.quantity, REJECT_CREDIT);
+		return;
+	}
+	if (needed < held)
+		order.trader->release(held - needed);
+
+	PriceLadder & ladder = edit.side == SIDE_BUY ? node.bids : node.asks;
+	ladder.erase(entry);
+	order.price = edit.price;
+	order.sequence = edit.sequence;
+	m_orders.insert(order.id, ladder.push(order));
+	match(node);
+}
+
+// Editing an existing trade -- change the quantity
+// Lowering the quantity amends the order in place and keeps its time priority.
+// Raising it sends the order to the back of its price level, like a new order, and
+// reserves the extra notional: if the trader can't cover it the edit is ignored.
+// Quantity edits and deletes never move a price, thus they can't make the book cross
+// and don't match the node
+void MatchingEngine::edit_quantity(ExchangeNode & node, const Order & edit) {
+	if (!node.trading) {
+		report(node, edit, REPORT_REJECT, 0, 0, 0, REJECT_HALTED);
+		return;
+	}
+
+	OrderEntry* entry = find_order(node, edit);
+	if (entry == nullptr) {
+		report(node, edit, REPORT_REJECT, 0, 0, 0, REJECT_UNKNOWN_ORDER);
+		return;
+	}
+
+	PriceLadder & ladder = edit.side == SIDE_BUY ? node.bids : node.asks;
+
+	// Nothing left to trade, treat it as a delete
+	if (edit.quantity <= 0) {
+		remove(node, edit);
+		return;
+	}
+
+	if (edit.quantity <= entry->order.quantity) {
+		entry->order.trader->release(reservation(entry->order, node.tick_size, entry->order.quantity - edit.quantity));
+		ladder.amend_quantity(entry, edit.quantity);
+		return;
+	}
+
+	Order order = entry->order;
+	if (!order.trader->reserve(reservation(order, node.tick_size, edit.quantity - order.quantity))) {
+		report(node, order, REPORT_REJECT, 0, 0, order.quantity, REJECT_CREDIT);
+		return;
+	}
+	ladder.erase(entry);
+	order.quantity = edit.quantity;
+	order.sequence = edit.sequence;
+	m_orders.insert(order.id, ladder.push(order));
+}
+
+// Deleting an existing trade. Its reservation goes back to the trader and the delete is acknowledged
+void MatchingEngine::remove(ExchangeNode & node, const Order & edit) {
+	OrderEntry* entry = find_order(node, edit);
+	if (entry == nullptr) {
+		report(node, edit, REPORT_REJECT, 0, 0, 0, REJECT_UNKNOWN_ORDER);
+		return;
+	}
+
+	entry->order.trader->release(reservation(entry->order, node.tick_size, entry->order.quantity));
+	report(node, entry->order, REPORT_CANCEL_ACK, 0, entry->order.quantity, 0);
+	PriceLadder & ladder = edit.side == SIDE_BUY ? node.bids : node.asks;
+	ladder.erase(entry);
+	m_orders.erase(edit.id);
+	if (node.bids.empty() && node.asks.empty())
+		node.available.store(false, std::memory_order_relaxed);
+}
+
+// Halting a stock. The messages before the halt were matched as they were applied,
+// from now on the stock stops matching. Its resting orders are cancelled best level
+// first: each one gives its reservation back to the trader and is reported as a cancel,
+// thus no cash stays locked in a book that can no longer trade
+void MatchingEngine::halt(ExchangeNode & node) {
+	node.trading = false;
+
+	PriceLadder* sides[2] = { &node.bids, &node.asks };
+	int s = 0;
+	for (; s < 2; ++s) {
+		OrderEntry* entry;
+		while ((entry = sides[s]->front()) != nullptr) {
+			Order order = entry->order;
+			order.trader->release(reservation(order, node.tick_size, order.quantity));
+			report(node, order, REPORT_CANCEL_ACK, 0, order.quantity, 0);
+			sides[s]->erase(entry);
+			m_orders.erase(order.id);
+		}
+	}
+	node.available.store(false, std::memory_order_relaxed);
+}
+
+//*** Books and auxiliary methods ***//
+
+// Wrapper method to update the order book. Copies the order into a
+// fixed-size record upon successful submission
+void MatchingEngine::updateOrderBook(const Order & order) {
+
+	OrderRecord record;
+	record.sequence = order.sequence;
+	record.trader_id = order.trader->getId();
+	record.order_id = order.id;
+	record.symbol = order.symbol;
+	record.side = order.side;
+	record.type = order.type;
+	record.price = order.price;
+	record.quantity = order.quantity;
+	record.submitted = order.submitted;
+	record.timestamp = order.timestamp;
+
+	// Submit to the book
+	std::unique_lock<std::mutex> lock(books_mt);
+	OrderBook.push_back(record);
+	lock.unlock();
+
+	if (m_journal != nullptr)
+		m_journal->append(JOURNAL_ORDER, &record, sizeof(record));
+}
+
+// Journals an edit, a delete, a listing or a halt, with its sequence number. Only
+// the journal keeps these, the in-memory books hold orders and fills
+void MatchingEngine::journal(const OrderMessage & msg) {
+	if (m_journal == nullptr)
+		return;
+
+	MessageRecord record;
+	record.sequence = msg.order.sequence;
+	record.trader_id = msg.order.trader != nullptr ? msg.order.trader->getId() : 0;
+	record.order_id = msg.order.id;
+	record.symbol = msg.node->id;
+	record.type = (unsigned char)msg.type;
+	record.side = msg.order.side;
+	record.price = msg.order.price;
+	record.quantity = msg.order.quantity;
+	record.timestamp = Clock::now();
+	m_journal->append(JOURNAL_MESSAGE, &record, sizeof(record));
+}
+
+// Appends this engine's Order book records
+void MatchingEngine::collectOrderBook(std::vector<OrderRecord> & book) {
+	std::unique_lock<std::mutex> lock(books_mt);
+	book.insert(book.end(), OrderBook.begin(), OrderBook.end());
+}
+
+// Appends this engine's Fill book records
+void MatchingEngine::collectFillBook(std::vector<FillRecord> & book) {
+	std::unique_lock<std::mutex> lock(books_mt);
+	book.insert(book.end(), FillBook.begin(), FillBook.end());
+}
+
+// Usage of the resting order pool
+const PoolStats MatchingEngine::orderPoolStats() {
+	return m_entry_pool.stats();
+}
+
+// Usage of the price level pool
+const PoolStats MatchingEngine::levelPoolStats() {
+	return m_level_pool.stats();
+}
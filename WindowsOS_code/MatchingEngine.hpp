@@ -0,0 +1,332 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ===============================================
+*
+*	MatchingEngine class definition
+*
+*/
+
+// Multiple inclusion guards to avoid linker errors
+// In case this file is included in multiple source files
+// we want to avoid re-compilations
+#ifndef MATCHING_ENGINE_HPP
+#define MATCHING_ENGINE_HPP
+
+// Necessary libraries
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>	// _mm_pause
+#endif
+
+#include "PriceLadder.hpp"
+#include "Clock.hpp"
+#include "MPSCQueue.hpp"
+#include "Records.hpp"
+#include "Journal.hpp"
+#include "ObjectPool.hpp"
+#include "IndexTable.hpp"
+#include "MarketData.hpp"
+#include "ExecutionReport.hpp"
+
+//*** ExchangeNode data structure ***//
+
+// This is a data structure that models a particular equity in the stock market
+// Every trading requests that refer to a stock will be handled by the ExchangeNode
+// of that stock. It consists of the stock name, an availability indicator that holds
+// true when there is at least one available trade there, and two PriceLadder objects
+// whose purpose is to sort and handle all requests appropriately. Bids are sorted
+// highest price first and asks lowest price first, so the two tops of the book meet
+// at the spread.
+// Prices in the ladders are integer ticks of the stock's tick size.
+// A halted stock is flagged twice: halted is set by the Exchange and turns new requests
+// away at the door, trading is cleared by the engine when it applies the halt, in order
+// with the rest of its messages, and cancels what rests in the ladders. Requests that
+// passed the door before the halt and reach the engine after it are rejected there.
+// The engine publishes the top of the book and the top book_depth levels of the stock
+// in two SeqLocks, thus any thread can read the market data at any time without a lock
+// and without slowing the engine down.
+struct ExchangeNode {
+	std::string										stock;
+	unsigned int									id;			// Index of the stock in the Exchange
+	Cash											tick_size;	// Smallest price increment, in minor units
+	PriceLadder										bids;		// Buy requests will be stored here
+	PriceLadder										asks;		// Sell requests will be stored here
+	std::atomic<bool>								available;	// Read by printers on other threads
+	std::atomic<bool>								halted;		// Read by brokers on other threads
+	bool											trading;	// False once the engine applied a halt
+	SeqLock<Quote>									quote;		// Best bid and offer, written by the engine
+	SeqLock<BookDepth>								depth;		// Top levels of both sides, written by the engine
+	std::uint64_t									last_sequence;	// Last message applied to the stock. Engine only
+	bool											touched;	// Changed since the last publication. Engine only
+
+	ExchangeNode() : stock(""), id(0), tick_size(default_tick_size), bids(PriceLadder::DESCENDING), asks(PriceLadder::ASCENDING),
+		available(false), halted(false), trading(true), last_sequence(0), touched(false) {}
+};
+
+//*** OrderMessage data structure ***//
+
+// Compact message that carries a submission, an edit or a delete from the broker's
+// thread to the matching engine through the ingress ring. It holds the Order and a
+// pointer to its stock, thus enqueueing it is a plain copy with no allocation.
+// The engine's sequencer stamps order.sequence of every message when it drains the ring.
+// Submissions carry the whole order. Edits and deletes carry the id, the trader and
+// the side of the resting order, and the new price (EDIT_PRICE) or the new
+// quantity (EDIT_QUANTITY) in the order's own fields.
+// LIST and HALT only carry the node: they list a stock on the engine intraday, or halt it
+struct OrderMessage {
+	enum Type { SUBMIT, EDIT_PRICE, EDIT_QUANTITY, DELETE, LIST, HALT };
+
+	Order			order;
+	ExchangeNode*	node;			// Stock of the order
+	Type			type;
+
+	OrderMessage() : node(nullptr), type(SUBMIT) {}
+};
+
+//*** Reservations ***//
+
+// Cash an order holds reserved for the given quantity: its notional at the limit price.
+// The Exchange reserves it on submission and the engine settles fills against it.
+// A market order has no limit price, thus it reserves nothing upfront and each of its
+// fills is reserved by the engine right before it settles
+inline Cash reservation(const Order & order, Cash tick_size, long long quantity) {
+	return order.type == ORDER_MARKET ? 0 : notional(order.price, tick_size, quantity);
+}
+
+//*** SubmitStatus ***//
+
+// Outcome of handing a message to the Exchange
+enum SubmitStatus {
+	SUBMITTED,		// Enqueued for the matching engine
+	REJECTED,		// Bad request (unknown or halted stock, bad side or type) or not enough buying power
+	BACKPRESSURE	// The engine's ingress ring is full, try again later
+};
+
+//*** WaitStrategy ***//
+
+// What the matching thread does when a pass finds no new message and no trade to fill
+//	1) BUSY_SPIN:	keeps polling the ring. Lowest latency, burns a core at all times
+//	2) SPIN_YIELD:	polls for a while, then yields the core to the OS scheduler between polls
+//	3) BLOCKING:	polls for a while, then parks on a condition variable (a futex on Linux,
+//					an SRW lock on Windows) until a broker enqueues a new message
+enum WaitStrategy {
+	BUSY_SPIN,
+	SPIN_YIELD,
+	BLOCKING
+};
+
+//*** MatchingEngine class ***//
+
+// One matching worker (shard) of the Exchange. Every ExchangeNode is pinned to exactly
+// one engine, which is the only one that ever touches its ladders. Each engine runs its
+// own matching thread over its own nodes, thus engines never contend with each other
+// and matching throughput grows with the number of engines.
+// Brokers never touch the ladders either: submissions, edits and deletes are copied into
+// the engine's lock-free ingress ring (MPSCQueue) and the matching thread drains the ring
+// and applies the messages in arrival order before every matching pass. When the ring is
+// full the broker gets BACKPRESSURE back instead of blocking.
+// The engine is also the sequencer of its instruments: every message drained from the
+// ring gets the next sequence number of the engine (1, 2, 3, ... without a gap) before
+// it reaches a book. Time priority and the trade price follow the sequence numbers, and
+// a message that can cross the spread (a new request or a new price) is matched right
+// after it is applied, before the next message. Thus the books and the fills depend only
+// on the sequence of messages, never on a clock or on how the ring was drained, and the
+// journal replays bit-for-bit. Matching only visits the instrument of the message, thus
+// its cost follows the flow and not the number of listed instruments.
+// When there is nothing to do, the matching thread waits as per its WaitStrategy, thus
+// low-latency boxes keep spinning while shared hosts only wake the engine on new flow.
+// In run-to-completion mode the engine has no thread at all: the broker that enqueues a
+// message also drains the ring, thus an aggressive order is matched on the broker's own
+// thread before the call returns, with no thread hop. Only one thread drains at a time;
+// a broker that finds another one draining leaves its message to it (flat combining),
+// thus the books keep a single owner at any moment and the sequence stays the ring order.
+// A new order is matched as a taker: it sweeps the opposite side, level by level, while
+// it crosses, and only the remainder of a limit order rests in the book. IOC, fill-or-kill
+// and market orders never rest, thus they take no entry and need no delete afterwards.
+// Every resting order of the engine is indexed by its order id, thus edits and deletes
+// reach the resting entry in O(1) instead of scanning the ladders. Entries and price
+// levels come from the engine's pools and the index is an open-addressing table, all
+// sized upfront, thus steady-state matching makes no heap allocation.
+// The engine publishes the market data of the stocks it changed once per drain pass, and
+// at least every publish_interval messages under sustained flow: a burst of messages on a
+// stock costs one snapshot (conflation), and readers see books that are consistent with
+// a message boundary, since the engine publishes between messages.
+// Traders that subscribed to their execution reports get them from the engine as it applies
+// the events: a fill or partial fill for both sides of every trade, a cancel ack when an
+// order leaves the book without trading, a reject when an edit or delete is ignored.
+// Each engine also keeps the Order and Fill book records of its own instruments and,
+// if the Exchange is configured with a journal directory, appends them to its own
+// memory-mapped journal as they are produced.
+class MatchingEngine {
+public:
+	// The constructor creates an idle engine with an ingress ring of the given capacity
+	// and the given wait strategy. Its pools hold order_capacity resting orders and
+	// level_capacity price levels, and every ladder indexes ladder_levels levels before
+	// its index grows. Nodes are pinned before start().
+	// The engine takes ownership of the journal, if any. With run_to_completion the engine
+	// starts no thread and the brokers match their own messages (the wait strategy is unused).
+	// Without market_data the engine publishes no snapshot
+	MatchingEngine(std::size_t ring_capacity, WaitStrategy wait, std::size_t order_capacity,
+		std::size_t level_capacity, std::size_t ladder_levels, Journal * journal = nullptr, bool run_to_completion = false,
+		bool market_data = true);
+
+	// The destructor stops the matching thread if it is still running and closes the journal
+	~MatchingEngine();
+
+	// Pins an instrument to this engine. Called before start(). Instruments listed
+	// intraday are pinned by the matching thread itself, through a LIST message
+	void pin(ExchangeNode * node);
+
+	// Launch and stop the matching thread
+	void start();
+	void stop();
+
+	// Ingress. Called by any broker thread: a single lock-free enqueue.
+	// A parked engine is woken up, otherwise the broker never touches a lock
+	inline SubmitStatus enqueue(const OrderMessage & msg) {
+		if (!ingress.push(msg))
+			return BACKPRESSURE;
+
+		if (m_inline) {
+			run();
+			return SUBMITTED;
+		}
+
+		if (m_wait == BLOCKING) {
+			// Pairs with the fence in idle(): either the engine sees the new message
+			// before it parks, or the broker sees the engine parked
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (sleeping.load(std::memory_order_relaxed))
+				wake();
+		}
+		return SUBMITTED;
+	}
+
+	// Ingress of a batch: one claim of the ring and at most one wake-up for all the messages.
+	// Returns the number of messages enqueued, the rest didn't fit in the ring
+	inline std::size_t enqueue(const OrderMessage * msgs, std::size_t count) {
+		std::size_t pushed = ingress.push(msgs, count);
+
+		if (pushed != 0 && m_inline)
+			run();
+		else if (pushed != 0 && m_wait == BLOCKING) {
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (sleeping.load(std::memory_order_relaxed))
+				wake();
+		}
+		return pushed;
+	}
+
+	// Waits until every message enqueued before the call has been applied and matched
+	void flush();
+
+	// Append this engine's Order and Fill book records to the given books
+	void collectOrderBook(std::vector<OrderRecord> & book);
+	void collectFillBook(std::vector<FillRecord> & book);
+
+	// Usage of the pools. Safe to call from any thread
+	const PoolStats orderPoolStats();
+	const PoolStats levelPoolStats();
+
+private:
+	std::vector<ExchangeNode*>	m_nodes;		// Instruments pinned to this engine
+	std::uint64_t				m_sequence;		// Last sequence number given. Matching thread only
+
+	// Book storage. Only the matching thread touches it
+	ObjectPool<OrderEntry>						m_entry_pool;	// Resting orders
+	ObjectPool<PriceLevel>						m_level_pool;	// Price levels
+	IndexTable<std::uint64_t, OrderEntry*>		m_orders;		// Order id -> resting entry
+	std::size_t									m_ladder_levels;
+
+	// Ingress ring, filled by the brokers and drained by the matching thread
+	MPSCQueue<OrderMessage>		ingress;
+
+	// Threading shield. The books are the only state read by other threads
+	std::mutex					books_mt;
+	std::thread					ignite;
+	std::atomic<bool>			running;
+	std::atomic<std::size_t>	applied;		// Messages applied and matched by the matching thread
+
+	// Idle handling
+	WaitStrategy				m_wait;
+	std::atomic<bool>			sleeping;		// True while the engine is parked (BLOCKING)
+	std::mutex					wait_mt;
+	std::condition_variable		wait_cv;
+
+	void idle(unsigned & idle_passes);
+	void wake();
+
+	// Run to completion. The flag is held by the one thread draining the ring
+	bool						m_inline;
+	std::atomic<bool>			owner;
+
+	// Drains the ring on the calling thread, unless another thread is draining it
+	void run();
+
+	// Market data. Stocks changed since the last publication, written by the draining thread
+	bool						m_market_data;
+	std::vector<ExchangeNode*>	m_touched;
+
+	// Writes the snapshots of a stock, and of every stock changed since the last publication
+	void publish(ExchangeNode & node);
+	void publish();
+
+	// Matching Engine stuff
+	void matching_engine();
+	std::size_t drain();
+	bool match(ExchangeNode & node);
+	void execute(ExchangeNode & node, OrderEntry * buy_order, OrderEntry * sell_order);
+
+	// Matches an incoming order against the opposite side. Its quantity is what is left
+	void take(ExchangeNode & node, Order & taker);
+
+	// True if the opposite side can fill the whole order within its limit (fill-or-kill)
+	bool fillable(ExchangeNode & node, const Order & taker);
+
+	// Settles a trade between two accounts against their reservations and logs the fill
+	void settle(ExchangeNode & node, const Order & buyer, const Order & seller, Ticks price, long long quantity);
+
+	// Pushes an execution report on an order to the subscription of its trader, if any
+	void report(ExchangeNode & node, const Order & order, ReportType type, Ticks price, long long quantity,
+		long long leaves, RejectReason reason = REJECT_NONE);
+
+	// Message handlers. They run on the matching thread only
+	void submit(ExchangeNode & node, const Order & order);
+	void edit_price(ExchangeNode & node, const Order & edit);
+	void edit_quantity(ExchangeNode & node, const Order & edit);
+	void remove(ExchangeNode & node, const Order & edit);
+	void halt(ExchangeNode & node);
+
+	// Resting entry lookup through the node's index. Returns nullptr if the trader's
+	// order is not resting on the given side
+	OrderEntry* find_order(ExchangeNode & node, const Order & edit);
+
+	// Order Book
+	std::vector<OrderRecord> OrderBook;
+	void updateOrderBook(const Order & order);
+
+	// Journals a message other than a submission
+	void journal(const OrderMessage & msg);
+
+	// Fill Book
+	std::vector<FillRecord> FillBook;
+
+	// Durable copy of both books. Written by the matching thread only, nullptr if disabled
+	Journal* m_journal;
+
+	// No copies of an engine: it owns a thread and its instruments
+	MatchingEngine(const MatchingEngine&);
+	MatchingEngine& operator=(const MatchingEngine&);
+};
+
+#endif // !MATCHING_ENGINE_HPP
@@ -0,0 +1,176 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	Testing the MatchingEngine order types
+*
+*/
+
+// Import the necessary files
+#include <iostream>
+#include <iomanip>
+#include "MatchingEngine.hpp"
+#include "ExecutionReport.hpp"
+
+// Submits an order to the engine the way the Exchange does: the limit notional is
+// reserved out of the trader's buying power first
+static SubmitStatus submit(MatchingEngine & engine, ExchangeNode & node, Trader * trader, OrderSide side, OrderType type,
+	double price, long long quantity) {
+	static std::uint64_t next_id = 1;
+
+	OrderMessage msg;
+	msg.type = OrderMessage::SUBMIT;
+	msg.node = &node;
+	msg.order.id = next_id++;
+	msg.order.trader = trader;
+	msg.order.side = side;
+	msg.order.type = type;
+	msg.order.price = type == ORDER_MARKET ? 0 : to_ticks(price, node.tick_size);
+	msg.order.quantity = quantity;
+	msg.order.symbol = node.id;
+	if (!trader->reserve(reservation(msg.order, node.tick_size, quantity)))
+		return REJECTED;
+	return engine.enqueue(msg);
+}
+
+// What the reports of a trader said since the last call
+struct Outcome {
+	long long	filled;
+	long long	cancelled;
+	long long	fills;
+};
+
+static Outcome outcome(ExecutionReports & reports) {
+	Outcome o = { 0, 0, 0 };
+	ExecutionReport report;
+	while (reports.poll(report)) {
+		if (report.type == REPORT_FILL || report.type == REPORT_PARTIAL_FILL) {
+			o.filled += report.quantity;
+			++o.fills;
+		}
+		else if (report.type == REPORT_CANCEL_ACK)
+			o.cancelled += report.quantity;
+	}
+	return o;
+}
+
+int main() {
+
+	std::cout << "*** Testing MatchingEngine order types ***\n\n";
+	std::cout << std::boolalpha << std::fixed << std::setprecision(2);
+
+	// One engine in run-to-completion mode, thus every submission is matched before
+	// submit() returns. The engine is declared first and outlives the stock's ladders
+	MatchingEngine engine(64, BLOCKING, 64, 16, 16, nullptr, true);
+	ExchangeNode node;
+	node.stock = "GOOGL";
+	engine.pin(&node);
+	engine.start();
+
+	Trader maker(1'000'000);
+
+	// Test 1: An IOC order fills what crosses its limit and cancels the rest. It never
+	// rests, and the reservation of the cancelled part goes back to the trader
+	std::cout << "*** Test 1:\n\n";
+	{
+		Trader taker(1'000'000);
+		ExecutionReports reports;
+		taker.subscribe(&reports);
+
+		submit(engine, node, &maker, SIDE_SELL, ORDER_LIMIT, 10.00, 5);
+		submit(engine, node, &maker, SIDE_SELL, ORDER_LIMIT, 10.01, 5);
+		submit(engine, node, &maker, SIDE_SELL, ORDER_LIMIT, 10.02, 5);
+		submit(engine, node, &taker, SIDE_BUY, ORDER_IOC, 10.01, 20);
+
+		Outcome o = outcome(reports);
+		Quote quote = node.quote.read();
+		std::cout << "Filled: " << o.filled << " in " << o.fills << " fills, cancelled: " << o.cancelled << " (expected 10 in 2 fills, 10)\n";
+		std::cout << "Best bid quantity: " << quote.bid.quantity << " (expected 0, the IOC didn't rest)\n";
+		std::cout << "Best ask: " << to_price(quote.ask.price, node.tick_size) << " x " << quote.ask.quantity << " (expected 10.02 x 5)\n";
+		std::cout << "Taker's cash: " << to_dollars(taker.cash()) << ", all free: " << (taker.buyingPower() == taker.cash())
+			<< " (expected 999899.95, true)\n\n\n";
+
+		taker.subscribe(nullptr);
+	}
+
+	// Success!
+
+	// Test 2: A fill-or-kill order is killed whole when the depth within its limit is short,
+	// and filled completely when the depth is enough
+	std::cout << "*** Test 2:\n\n";
+	{
+		Trader taker(1'000'000);
+		ExecutionReports reports;
+		taker.subscribe(&reports);
+
+		submit(engine, node, &maker, SIDE_SELL, ORDER_LIMIT, 10.03, 5);
+		submit(engine, node, &taker, SIDE_BUY, ORDER_FOK, 10.03, 11);
+
+		Outcome killed = outcome(reports);
+		Quote quote = node.quote.read();
+		std::cout << "Short depth. Filled: " << killed.filled << ", cancelled: " << killed.cancelled << " (expected 0, 11)\n";
+		std::cout << "Asks untouched: " << quote.ask.quantity << " at the best level (expected 5)\n";
+		std::cout << "Taker's cash: " << to_dollars(taker.cash()) << ", all free: " << (taker.buyingPower() == taker.cash())
+			<< " (expected 1000000.00, true)\n";
+
+		submit(engine, node, &taker, SIDE_BUY, ORDER_FOK, 10.03, 10);
+
+		Outcome filled = outcome(reports);
+		quote = node.quote.read();
+		std::cout << "Enough depth. Filled: " << filled.filled << " in " << filled.fills << " fills, cancelled: " << filled.cancelled
+			<< " (expected 10 in 2 fills, 0)\n";
+		std::cout << "Ask quantity left: " << quote.ask.quantity << " (expected 0)\n";
+		std::cout << "Taker's cash: " << to_dollars(taker.cash()) << ", all free: " << (taker.buyingPower() == taker.cash())
+			<< " (expected 999899.75, true)\n\n\n";
+
+		taker.subscribe(nullptr);
+	}
+
+	// Success!
+
+	// Test 3: A market order sweeps the opposite side at any price. It reserves each fill as
+	// it goes, stops where the trader can't cover the next one, and cancels the rest: once
+	// the sweep is over the trader has no cash left reserved
+	std::cout << "*** Test 3:\n\n";
+	{
+		Trader taker(1'000'000), small(1'035);
+		ExecutionReports reports, small_reports;
+		taker.subscribe(&reports);
+		small.subscribe(&small_reports);
+
+		submit(engine, node, &maker, SIDE_SELL, ORDER_LIMIT, 10.00, 5);
+		submit(engine, node, &maker, SIDE_SELL, ORDER_LIMIT, 11.00, 5);
+		submit(engine, node, &taker, SIDE_BUY, ORDER_MARKET, 0, 8);
+
+		Outcome o = outcome(reports);
+		std::cout << "Filled: " << o.filled << " in " << o.fills << " fills, cancelled: " << o.cancelled << " (expected 8 in 2 fills, 0)\n";
+		std::cout << "Taker's cash: " << to_dollars(taker.cash()) << ", all free: " << (taker.buyingPower() == taker.cash())
+			<< " (expected 999917.00, true)\n";
+
+		// 2 left at 11.00, then the book is empty
+		submit(engine, node, &taker, SIDE_BUY, ORDER_MARKET, 0, 10);
+		o = outcome(reports);
+		std::cout << "Past the depth. Filled: " << o.filled << ", cancelled: " << o.cancelled << " (expected 2, 8)\n";
+		std::cout << "Taker's cash: " << to_dollars(taker.cash()) << ", all free: " << (taker.buyingPower() == taker.cash())
+			<< " (expected 999895.00, true)\n";
+
+		// $1035 covers the fill of 2 shares at 300.00, not the next fill of 3
+		submit(engine, node, &maker, SIDE_SELL, ORDER_LIMIT, 300.00, 2);
+		submit(engine, node, &maker, SIDE_SELL, ORDER_LIMIT, 300.00, 5);
+		submit(engine, node, &small, SIDE_BUY, ORDER_MARKET, 0, 5);
+		o = outcome(small_reports);
+		std::cout << "Past the cash. Filled: " << o.filled << ", cancelled: " << o.cancelled << " (expected 2, 3)\n";
+		std::cout << "Small trader's cash: " << to_dollars(small.cash()) << ", all free: " << (small.buyingPower() == small.cash())
+			<< " (expected 435.00, true)\n\n\n";
+
+		taker.subscribe(nullptr);
+		small.subscribe(nullptr);
+	}
+
+	// Success!
+
+	engine.stop();
+	return 0;
+}
@@ -0,0 +1,143 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	ObjectPool definition and implementation
+*
+*/
+
+// Multiple inclusion guards to avoid linker errors
+// In case this file is included in multiple source files
+// we want to avoid re-compilations
+#ifndef OBJECT_POOL_HPP
+#define OBJECT_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+//*** PoolStats data structure ***//
+
+// Usage of a pool, as read by the Exchange
+struct PoolStats {
+	std::size_t		capacity;		// Objects the pool can hand out without allocating
+	std::size_t		in_use;			// Objects handed out right now
+	std::size_t		peak;			// Highest in_use so far
+	std::size_t		slabs;			// Slabs allocated. More than one means the pool had to grow
+
+	PoolStats() : capacity(0), in_use(0), peak(0), slabs(0) {}
+};
+
+//*** ObjectPool class ***//
+
+// Slab allocator for the objects of the order book. The pool allocates its objects in
+// large slabs upfront and threads the free ones on an intrusive free list, thus handing
+// out or taking back an object is a couple of pointer moves in O(1) and never calls into
+// the general-purpose allocator. Pools are sized when the Exchange opens: as long as the
+// book stays within the capacity, matching makes no heap allocation at all. If the book
+// outgrows it the pool adds another slab of the same size, and the stats tell.
+// A pool has a single owner thread (its matching engine). The stats are atomics so that
+// other threads can read them at any time.
+// This is a template, thus the implementation lives in the header as well
+template <typename T>
+class ObjectPool {
+public:
+	// The constructor allocates the first slab
+	ObjectPool(std::size_t capacity) : m_free(nullptr), m_slabs(nullptr), m_slab_size(capacity == 0 ? 1 : capacity),
+		m_capacity(0), m_in_use(0), m_peak(0), m_slab_count(0) {
+		grow();
+	}
+
+	// The destructor reclaims every slab. Objects still handed out are not destroyed
+	~ObjectPool() {
+		while (m_slabs != nullptr) {
+			Slab* next = m_slabs->next;
+			delete[] m_slabs->nodes;
+			delete m_slabs;
+			m_slabs = next;
+		}
+	}
+
+	// Constructs an object in a free slot and hands it out
+	template <typename... Args>
+	inline T* acquire(Args&&... args) {
+		if (m_free == nullptr)
+			grow();
+
+		Node* node = m_free;
+		m_free = node->next;
+
+		std::size_t in_use = m_in_use.load(std::memory_order_relaxed) + 1;
+		m_in_use.store(in_use, std::memory_order_relaxed);
+		if (in_use > m_peak.load(std::memory_order_relaxed))
+			m_peak.store(in_use, std::memory_order_relaxed);
+
+		return new (node->storage) T(std::forward<Args>(args)...);
+	}
+
+	// Destroys an object and takes its slot back
+	inline void release(T * object) {
+		object->~T();
+		Node* node = reinterpret_cast<Node*>(object);
+		node->next = m_free;
+		m_free = node;
+		m_in_use.store(m_in_use.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+	}
+
+	// Usage of the pool. Safe to call from any thread
+	const PoolStats stats() {
+		PoolStats s;
+		s.capacity = m_capacity.load(std::memory_order_relaxed);
+		s.in_use = m_in_use.load(std::memory_order_relaxed);
+		s.peak = m_peak.load(std::memory_order_relaxed);
+		s.slabs = m_slab_count.load(std::memory_order_relaxed);
+		return s;
+	}
+
+private:
+	// A slot holds either a live object or the link to the next free slot
+	union Node {
+		Node*						next;
+		alignas(T) unsigned char	storage[sizeof(T)];
+	};
+
+	struct Slab {
+		Node*	nodes;
+		Slab*	next;
+	};
+
+	Node*						m_free;			// Free list
+	Slab*						m_slabs;		// Every slab, for the destructor
+	std::size_t					m_slab_size;	// Objects per slab
+
+	std::atomic<std::size_t>	m_capacity;
+	std::atomic<std::size_t>	m_in_use;
+	std::atomic<std::size_t>	m_peak;
+	std::atomic<std::size_t>	m_slab_count;
+
+	// Allocates a slab and threads its slots on the free list
+	void grow() {
+		Slab* slab = new Slab;
+		slab->nodes = new Node[m_slab_size];
+		slab->next = m_slabs;
+		m_slabs = slab;
+
+		std::size_t i = m_slab_size;
+		for (; i > 0; --i) {
+			slab->nodes[i - 1].next = m_free;
+			m_free = &slab->nodes[i - 1];
+		}
+
+		m_capacity.store(m_capacity.load(std::memory_order_relaxed) + m_slab_size, std::memory_order_relaxed);
+		m_slab_count.store(m_slab_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+
+	// No copies of a pool: it owns its slabs
+	ObjectPool(const ObjectPool &);
+	ObjectPool& operator=(const ObjectPool &);
+};
+
+#endif // !OBJECT_POOL_HPP
@@ -0,0 +1,66 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	Order data structure
+*
+*/
+
+// Multiple inclusion guards to avoid linker errors
+// In case this file is included in multiple source files
+// we want to avoid re-compilations
+#ifndef ORDER_HPP
+#define ORDER_HPP
+
+#include <cstdint>
+
+#include "FixedPoint.hpp"
+
+class Trader;
+
+//*** OrderSide ***//
+
+// Side of an order, in one byte
+enum OrderSide : unsigned char { SIDE_BUY, SIDE_SELL };
+
+//*** OrderType ***//
+
+// What happens to an order that the book can't fill on arrival, in one byte
+//	1) ORDER_LIMIT:		the remainder rests in the book at the limit price
+//	2) ORDER_IOC:		immediate-or-cancel, fills what crosses its limit and cancels the rest
+//	3) ORDER_FOK:		fill-or-kill, fills completely within its limit or not at all
+//	4) ORDER_MARKET:	fills at any price what the opposite side holds and cancels the rest
+// Only limit orders ever rest, thus the other types never take a book entry
+enum OrderType : unsigned char { ORDER_LIMIT, ORDER_IOC, ORDER_FOK, ORDER_MARKET };
+
+//*** Order data structure ***//
+
+// The exchange's own representation of a request. A Request is the client's ticket:
+// strings, a calendar timestamp and virtual getters, spread over two heap objects.
+// The Exchange turns it into an Order once, on submission (see Request::toOrder), and
+// from then on the ladders and the matching engine only read plain integers that sit
+// together in one cache line: no virtual call, no pointer chase, no string compare.
+// The order id is assigned by the Exchange and identifies the order in edits and deletes.
+// The sequence number is stamped by the engine's sequencer when the order reaches the
+// book, and decides time priority: ties break on an integer compare, not on a clock.
+// The symbol is interned: it is the index of the stock in the Exchange.
+struct alignas(64) Order {
+	std::uint64_t	id;				// Order id, assigned by the Exchange
+	Trader*			trader;			// Account that settles the order
+	Ticks			price;			// Limit price, in ticks of the stock
+	long long		quantity;		// Remaining quantity
+	std::uint64_t	sequence;		// Sequence number of the message that placed it (time priority)
+	long long		submitted;		// Time of submission to the Exchange, in nanoseconds (Clock)
+	long long		timestamp;		// Time of arrival in the book, in nanoseconds (Clock)
+	std::uint32_t	symbol;			// Interned symbol id
+	OrderSide		side;
+	OrderType		type;
+
+	Order() : id(0), trader(nullptr), price(0), quantity(0), sequence(0), submitted(0), timestamp(0), symbol(0), side(SIDE_BUY), type(ORDER_LIMIT) {}
+};
+
+static_assert(sizeof(Order) == 64, "An Order must fit in one cache line");
+
+#endif // !ORDER_HPP
@@ -0,0 +1,217 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	PriceLadder implementation
+*
+*/
+
+#include "PriceLadder.hpp"
+
+//*** Constructor and Destructor ***//
+
+// The constructor starts with an empty ladder sorted as per the side it models.
+// Until pools are attached, entries and levels come from the heap
+PriceLadder::PriceLadder(Sorting sorting) : m_sorting(sorting), m_best(nullptr), m_count(0),
+	m_entry_pool(nullptr), m_level_pool(nullptr) {}
+
+// The destructor walks the chain of levels and reclaims every level and entry
+PriceLadder::~PriceLadder() {
+	PriceLevel* level = m_best;
+	while (level != nullptr) {
+		OrderEntry* entry = level->head;
+		while (entry != nullptr) {
+			OrderEntry* next = entry->next;
+			free_entry(entry);
+			entry = next;
+		}
+		PriceLevel* worse = level->worse;
+		free_level(level);
+		level = worse;
+	}
+}
+
+// Takes entries and levels from the given pools from now on, and sizes the level index.
+// Only called on an empty ladder
+void PriceLadder::attach(ObjectPool<OrderEntry> * entries, ObjectPool<PriceLevel> * levels, std::size_t level_capacity) {
+	m_entry_pool = entries;
+	m_level_pool = levels;
+	m_levels.reserve(level_capacity);
+}
+
+//*** Level management ***//
+
+// Creates a new level and links it in the chain. The walk starts from the top of the book
+// and stops at the first level the new price ranks ahead of
+PriceLevel* PriceLadder::insert_level(Ticks price) {
+	PriceLevel* level = m_level_pool != nullptr ? m_level_pool->acquire(price) : new PriceLevel(price);
+	m_levels.insert(price, level);
+
+	// Case new top of the book (also covers the empty ladder)
+	if (m_best == nullptr || better(price, m_best->price)) {
+		level->worse = m_best;
+		if (m_best != nullptr)
+			m_best->better = level;
+		m_best = level;
+		return level;
+	}
+
+	// Find the last level that ranks ahead of the new price
+	PriceLevel* at = m_best;
+	while (at->worse != nullptr && better(at->worse->price, price))
+		at = at->worse;
+
+	// Link after it
+	level->better = at;
+	level->worse = at->worse;
+	if (at->worse != nullptr)
+		at->worse->better = level;
+	at->worse = level;
+	return level;
+}
+
+// Unlinks an empty level from the chain and reclaims it
+void PriceLadder::remove_level(PriceLevel * level) {
+	if (level->better != nullptr)
+		level->better->worse = level->worse;
+	else
+		m_best = level->worse;
+
+	if (level->worse != nullptr)
+		level->worse->better = level->better;
+
+	m_levels.erase(level->price);
+	free_level(level);
+}
+
+// Returns an entry to its pool, or to the heap
+void PriceLadder::free_entry(OrderEntry * entry) {
+	if (m_entry_pool != nullptr)
+		m_entry_pool->release(entry);
+	else
+		delete entry;
+}
+
+// Returns a level to its pool, or to the heap
+void PriceLadder::free_level(PriceLevel * level) {
+	if (m_level_pool != nullptr)
+		m_level_pool->release(level);
+	else
+		delete level;
+}
+
+//*** Modifiers ***//
+
+// Appends an order at the back of its price level. Existing levels are found in O(1)
+// through the hash table, thus the common case doesn't walk the ladder at all
+OrderEntry* PriceLadder::push(const Order & order) {
+	Ticks price = order.price;
+
+	PriceLevel* level;
+	PriceLevel** found = m_levels.find(price);
+	if (found != nullptr)
+		level = *found;
+	else
+		level = insert_level(price);
+
+	OrderEntry* entry = m_entry_pool != nullptr ? m_entry_pool->acquire(order) : new OrderEntry(order);
+	entry->level = level;
+	entry->prev = level->tail;
+	if (level->tail != nullptr)
+		level->tail->next = entry;
+	else
+		level->head = entry;
+	level->tail = entry;
+
+	level->quantity += order.quantity;
+	++level->count;
+	++m_count;
+	return entry;
+}
+
+// Unlinks a resting entry from its level in O(1)
+void PriceLadder::erase(OrderEntry * entry) {
+	PriceLevel* level = entry->level;
+
+	if (entry->prev != nullptr)
+		entry->prev->next = entry->next;
+	else
+		level->head = entry->next;
+
+	if (entry->next != nullptr)
+		entry->next->prev = entry->prev;
+	else
+		level->tail = entry->prev;
+
+	level->quantity -= entry->order.quantity;
+	--level->count;
+	--m_count;
+	free_entry(entry);
+
+	if (level->count == 0)
+		remove_level(level);
+}
+
+// Changes the quantity of a resting entry in place, thus it keeps its place in the queue
+void PriceLadder::amend_quantity(OrderEntry * entry, long long new_quantity) {
+	entry->level->quantity += new_quantity - entry->order.quantity;
+	entry->order.quantity = new_quantity;
+}
+
+// Reduces a resting entry by the filled quantity. A completely filled entry leaves the ladder
+bool PriceLadder::fill(OrderEntry * entry, long long quantity) {
+	long long remaining = entry->order.quantity - quantity;
+	if (remaining > 0) {
+		amend_quantity(entry, remaining);
+		return false;
+	}
+	erase(entry);
+	return true;
+}
+
+// Adds up the levels from the top of the book while they are within the limit.
+// A level is within the limit unless the limit ranks ahead of it on this side
+long long PriceLadder::depth(Ticks limit, long long wanted) {
+	long long quantity = 0;
+	PriceLevel* level = m_best;
+	while (level != nullptr && quantity < wanted && !better(limit, level->price)) {
+		quantity += level->quantity;
+		level = level->worse;
+	}
+	return quantity;
+}
+
+//*** Auxiliary methods ***//
+
+// Getter method for the number of resting orders
+const std::size_t PriceLadder::size() {
+	return m_count;
+}
+
+// Getter method for the number of price levels
+const std::size_t PriceLadder::levels() {
+	return m_levels.size();
+}
+
+// Boolean method to check whether or not the ladder is empty
+bool PriceLadder::empty() {
+	return m_best == nullptr;
+}
+
+// Print method that iterates the levels from the top of the book and prints
+// the information of each resting order
+void PriceLadder::print() {
+	PriceLevel* level = m_best;
+	for (; level != nullptr; level = level->worse) {
+		std::cout << "Level: " << level->price << " ticks, Quantity: " << level->quantity << ", Orders: " << level->count << "\n";
+		OrderEntry* entry = level->head;
+		for (; entry != nullptr; entry = entry->next) {
+			std::cout << "Order: " << entry->order.id << ", " << (entry->order.side == SIDE_BUY ? "BUY" : "SELL")
+				<< ", " << entry->order.quantity << " @ " << entry->order.price << " ticks";
+			std::cout << "\nTrader: "; entry->order.trader->info();
+			std::cout << "\nSequence: " << entry->order.sequence << ", Arrival: " << entry->order.timestamp << "\n\n";
+		}
+	}
+}
@@ -0,0 +1,153 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	PriceLadder definition
+*
+*/
+
+// Multiple inclusion guards to avoid linker errors
+// In case this file is included in multiple source files
+// we want to avoid re-compilations
+#ifndef PRICE_LADDER_HPP
+#define PRICE_LADDER_HPP
+
+// Additional headers to be used below:
+//	1) Order data structure
+//	2) Trader class, for printing
+#include "Order.hpp"
+#include "Trader.hpp"
+#include "ObjectPool.hpp"
+#include "IndexTable.hpp"
+
+#include <iostream>
+
+struct PriceLevel;
+
+//*** OrderEntry data structure ***//
+
+// A resting order in the ladder. It holds the Order and links it into the
+// FIFO queue of its price level. The queue is an intrusive doubly linked list,
+// so an entry can be appended or unlinked in O(1) without touching its neighbours
+struct OrderEntry {
+	Order			order;			// The resting order, first in the entry's cache lines
+	OrderEntry*		prev;			// Older order at the same price
+	OrderEntry*		next;			// Newer order at the same price
+	PriceLevel*		level;			// Price level that owns this entry
+
+	OrderEntry(const Order & o) : order(o), prev(nullptr), next(nullptr), level(nullptr) {}
+};
+
+//*** PriceLevel data structure ***//
+
+// All resting orders at one price. Orders are kept in arrival order (head is the
+// oldest and fills first) and the level keeps the aggregate quantity so that depth
+// can be read without walking the queue. Levels are chained best-to-worst.
+// Prices are integer ticks, thus orders at the same price always meet in the same level.
+struct PriceLevel {
+	Ticks			price;			// Price of every order in the level
+	long long		quantity;		// Aggregate resting quantity
+	std::size_t		count;			// Number of resting orders
+	OrderEntry*		head;			// Oldest order (first to fill)
+	OrderEntry*		tail;			// Newest order
+	PriceLevel*		better;			// Next level towards the top of the book
+	PriceLevel*		worse;			// Next level away from the top of the book
+
+	PriceLevel(Ticks p) : price(p), quantity(0), count(0), head(nullptr), tail(nullptr), better(nullptr), worse(nullptr) {}
+};
+
+//*** PriceLadder class ***//
+
+// One side of an instrument's order book, made of price levels. Each level holds
+// a FIFO queue of orders, so priority is price first and time second.
+// The ladder keeps a pointer to the best level, which gives the top of the book in O(1),
+// and a hash table from price (in ticks) to level, which appends an order at an existing price in O(1).
+// Only a brand new price level has to find its place in the chain, and it does so by
+// walking from the top of the book -- new prices usually arrive close to the top.
+// The BUY side sorts in DESCENDING order (highest bid first) and the SELL side in
+// ASCENDING order (lowest ask first).
+// A matching engine attaches its pools to the ladders of its instruments, thus entries
+// and levels are recycled in O(1) and a book within the pool sizes never allocates.
+class PriceLadder {
+public:
+	enum Sorting { DESCENDING, ASCENDING };
+
+	// The constructor takes the sorting direction of the side it models
+	PriceLadder(Sorting sorting);
+
+	// The destructor reclaims every level and every resting entry
+	~PriceLadder();
+
+	// Takes entries and levels from the given pools, instead of the heap, and reserves
+	// room for the given number of levels in the price index. Called on an empty ladder
+	void attach(ObjectPool<OrderEntry> * entries, ObjectPool<PriceLevel> * levels, std::size_t level_capacity);
+
+	// Appends an order at the back of its price level. The order keeps the time of
+	// arrival it was stamped with on submission. Returns the resting entry
+	OrderEntry* push(const Order & order);
+
+	// Unlinks a resting entry from its level in O(1) and reclaims it.
+	// Empty levels are removed from the ladder
+	void erase(OrderEntry * entry);
+
+	// Changes the quantity of a resting entry in place (keeps its time priority)
+	void amend_quantity(OrderEntry * entry, long long new_quantity);
+
+	// Reduces a resting entry by a filled quantity and removes it when it is
+	// completely filled. Returns true if the entry was removed
+	bool fill(OrderEntry * entry, long long quantity);
+
+	// Resting quantity at prices a taker with the given limit can reach, counted from the
+	// top of the book with the level aggregates, thus it reads one number per level and
+	// never walks a queue. Stops counting once it reaches wanted
+	long long depth(Ticks limit, long long wanted);
+
+	// Auxiliary features
+	const std::size_t size();				// Returns the number of resting orders
+	const std::size_t levels();				// Returns the number of price levels
+	void print();							// Iterates and prints the levels best-to-worst
+	bool empty();							// Checks if the ladder is empty
+
+	// Top of the book in O(1). These methods are inlined for the same reasons as
+	// TradeHeap::pop(): the matching engine calls them on every pass
+	inline PriceLevel* best() {
+		return m_best;
+	}
+
+	inline OrderEntry* front() {
+		return m_best == nullptr ? nullptr : m_best->head;
+	}
+
+private:
+	Sorting									m_sorting;	// Direction of the ladder
+	PriceLevel*								m_best;		// Top of the book
+	IndexTable<Ticks, PriceLevel*>			m_levels;	// Price -> level lookup
+	std::size_t								m_count;	// Number of resting orders
+
+	// Pools of the matching engine, nullptr until attached
+	ObjectPool<OrderEntry>*					m_entry_pool;
+	ObjectPool<PriceLevel>*					m_level_pool;
+
+	// Returns true if price a ranks ahead of price b on this side
+	inline bool better(Ticks a, Ticks b) const {
+		return m_sorting == DESCENDING ? a > b : a < b;
+	}
+
+	// Creates a new level and links it at its place in the chain
+	PriceLevel* insert_level(Ticks price);
+
+	// Unlinks an empty level from the chain and reclaims it
+	void remove_level(PriceLevel * level);
+
+	// Give entries and levels back to their pools
+	void free_entry(OrderEntry * entry);
+	void free_level(PriceLevel * level);
+
+	// No copies of the ladder: entries are owned by the ladder
+	PriceLadder(const PriceLadder &);
+	PriceLadder& operator=(const PriceLadder &);
+};
+
+#endif // !PRICE_LADDER_HPP
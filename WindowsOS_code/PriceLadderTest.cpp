@@ -0,0 +1,164 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	Testing the PriceLadder class
+*
+*/
+
+// Import the necessary files
+#include <iostream>
+#include "PriceLadder.hpp"
+#include "Request.hpp"
+
+int main() {
+
+	std::cout << "*** Testing PriceLadder functionality ***\n\n";
+
+	// Test 1: Create a PriceLadder on the STACK and attempt to call the print method
+	// Confirm it's empty and that there is no top of the book
+	std::cout << "*** Test 1:\n\n";
+	PriceLadder ladder1(PriceLadder::DESCENDING);
+
+	ladder1.print(); // Nothing will be printed
+
+	std::cout << "Number of elements: " << ladder1.size() << "\n";
+	std::cout << "Is ladder empty? " << std::boolalpha << ladder1.empty() << "\n";
+	std::cout << "Has a top of the book? " << (ladder1.front() != nullptr) << "\n\n\n";
+
+	// Success!
+
+	// Test 2: Push a few BUY requests on a DESCENDING ladder. Two of them share a price,
+	// thus they must share a level and keep their arrival order. The ladder holds the
+	// Orders made from the requests, keyed by integer ticks of one cent
+	std::cout << "*** Test 2:\n\n";
+
+	Request * r1 = new AutoRequest("BUY", "GOOGL", 1020.8, 100);
+	Request * r2 = new AutoRequest("BUY", "GOOGL", 1021.5, 50);
+	Request * r3 = new AutoRequest("BUY", "GOOGL", 1020.8, 120);
+	Request * r4 = new AutoRequest("SELL", "GOOGL", 1022.0, 70);
+	Request * r5 = new AutoRequest("SELL", "GOOGL", 1023.0, 30);
+
+	Trader * t1 = new Trader(100000);
+	Trader * t2 = new Trader(500000);
+
+	Order trade1 = r1->toOrder(0, default_tick_size), trade2 = r2->toOrder(0, default_tick_size),
+		trade3 = r3->toOrder(0, default_tick_size), trade4 = r4->toOrder(0, default_tick_size),
+		trade5 = r5->toOrder(0, default_tick_size);
+	trade1.trader = t1; trade2.trader = t2; trade3.trader = t2; trade4.trader = t1; trade5.trader = t2;
+	trade1.id = 1; trade2.id = 2; trade3.id = 3; trade4.id = 4; trade5.id = 5;
+
+	// Expected order: (t2, 2) at 1021.5, then (t1, 1) and (t2, 3) at 1020.8
+	ladder1.push(trade1);
+	ladder1.push(trade2);
+	OrderEntry * entry3 = ladder1.push(trade3);
+
+	ladder1.print();
+	std::cout << "Number of elements: " << ladder1.size() << ", Number of levels: " << ladder1.levels() << "\n";
+	std::cout << "Best bid: $" << to_price(ladder1.best()->price, default_tick_size) << "\n\n\n";
+
+	// Success!
+
+	// Test 3: Push SELL requests on an ASCENDING ladder. The lowest ask must be on top
+	std::cout << "*** Test 3:\n\n";
+	PriceLadder ladder2(PriceLadder::ASCENDING);
+
+	ladder2.push(trade5);
+	ladder2.push(trade4);
+
+	std::cout << "Best ask: $" << to_price(ladder2.best()->price, default_tick_size) << " (expected $1022)\n\n\n";
+
+	// Success!
+
+	// Test 4: Amend, partially fill and erase entries. Check the level aggregates
+	std::cout << "*** Test 4:\n\n";
+
+	ladder1.amend_quantity(entry3, 20);
+	std::cout << "Level $1020.8 quantity after amend: " << entry3->level->quantity << " (expected 120)\n";
+
+	bool removed = ladder1.fill(ladder1.front(), 10);
+	std::cout << "Partial fill removed the order? " << removed << ", remaining: " << ladder1.front()->order.quantity << "\n";
+
+	removed = ladder1.fill(ladder1.front(), 40);
+	std::cout << "Complete fill removed the order? " << removed << ", best bid now: $" << to_price(ladder1.best()->price, default_tick_size) << "\n";
+
+	ladder1.erase(entry3);
+	std::cout << "Number of elements: " << ladder1.size() << ", Number of levels: " << ladder1.levels() << "\n\n\n";
+
+	// Success!
+
+	// Test 5: Stress test the ladder by adding many elements on a few levels,
+	// then drain it from the top of the book
+	std::cout << "*** Test 5:\n\n";
+	std::size_t no_elements = 150;
+	unsigned i = 0;
+	for (; i < no_elements; ++i) {
+		// Random rule for trade diversity
+		if (i % 2 == 0)
+			ladder2.push(trade4);
+		else
+			ladder2.push(trade5);
+	}
+
+	std::cout << "Number of elements: " << ladder2.size() << ", Number of levels: " << ladder2.levels() << "\n";
+
+	while (!ladder2.empty())
+		ladder2.erase(ladder2.front());
+
+	std::cout << "Is ladder empty? " << ladder2.empty() << "\n\n";
+
+	// Success!
+
+	// Test 6: Attach pools to a ladder. Entries and levels are recycled, thus pushing and
+	// draining many orders never grows the pools beyond their first slab
+	std::cout << "*** Test 6:\n\n";
+	ObjectPool<OrderEntry> entry_pool(64);
+	ObjectPool<PriceLevel> level_pool(8);
+	{
+		PriceLadder ladder3(PriceLadder::ASCENDING);
+		ladder3.attach(&entry_pool, &level_pool, 8);
+
+		unsigned round = 0;
+		for (; round < 100; ++round) {
+			for (i = 0; i < 50; ++i)
+				ladder3.push(i % 2 == 0 ? trade4 : trade5);
+			while (!ladder3.empty())
+				ladder3.erase(ladder3.front());
+		}
+
+		ladder3.push(trade4);
+		PoolStats entries = entry_pool.stats();
+		PoolStats levels = level_pool.stats();
+		std::cout << "Entries: capacity " << entries.capacity << ", in use " << entries.in_use << ", peak " << entries.peak << ", slabs " << entries.slabs << " (expected 1)\n";
+		std::cout << "Levels: capacity " << levels.capacity << ", in use " << levels.in_use << ", peak " << levels.peak << ", slabs " << levels.slabs << " (expected 1)\n";
+	}
+	std::cout << "Entries in use after the ladder is gone: " << entry_pool.stats().in_use << " (expected 0)\n\n";
+
+	// Success!
+
+	// Test 7: Depth within a limit, read from the level aggregates. Asks rest at $1022 (70)
+	// and $1023 (30). A buyer limited at $1022 reaches 70, at $1023 all 100, below $1022 none
+	std::cout << "*** Test 7:\n\n";
+	PriceLadder ladder4(PriceLadder::ASCENDING);
+	ladder4.push(trade4);
+	ladder4.push(trade5);
+
+	std::cout << "Depth up to $1022: " << ladder4.depth(to_ticks(1022.0, default_tick_size), 1000) << " (expected 70)\n";
+	std::cout << "Depth up to $1023: " << ladder4.depth(to_ticks(1023.0, default_tick_size), 1000) << " (expected 100)\n";
+	std::cout << "Depth up to $1021: " << ladder4.depth(to_ticks(1021.0, default_tick_size), 1000) << " (expected 0)\n";
+	std::cout << "Depth up to $1023, 50 wanted: " << ladder4.depth(to_ticks(1023.0, default_tick_size), 50) << " (expected 70, the first level covers it)\n\n";
+
+	// Success!
+
+	// Reclaim memory. The ladders reclaim their own entries
+
+	// Delete test traders
+	delete t1; delete t2;
+
+	// Delete test requests
+	delete r1; delete r2; delete r3; delete r4; delete r5;
+
+	return 0;
+}
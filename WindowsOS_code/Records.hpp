@@ -0,0 +1,76 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	Order and Fill book records
+*
+*/
+
+// Multiple inclusion guards to avoid linker errors
+// In case this file is included in multiple source files
+// we want to avoid re-compilations
+#ifndef RECORDS_HPP
+#define RECORDS_HPP
+
+#include <cstdint>
+
+#include "FixedPoint.hpp"
+#include "Order.hpp"
+#include "Clock.hpp"
+
+//*** Book records ***//
+
+// Fixed-size, plain old data entries of the Order and Fill books. The matching engine
+// only copies integers into them, thus logging a submission or a fill allocates
+// nothing and formats nothing. Text is produced only when somebody asks for
+// the books (see Exchange::format)
+
+// Every record carries the sequence number its engine gave the message behind it.
+// Sequence numbers are per engine: each engine numbers the messages of its own ring
+// 1, 2, 3, ... in the order it applies them
+
+// One accepted order
+struct OrderRecord {
+	std::uint64_t	sequence;					// Sequence number of the submission
+	std::uint64_t	trader_id;					// Trader::getId()
+	std::uint64_t	order_id;					// Order::id
+	unsigned int	symbol;						// Index of the stock in the Exchange
+	OrderSide		side;
+	OrderType		type;
+	Ticks			price;						// In ticks of the stock, 0 for market orders
+	long long		quantity;
+	long long		submitted;					// Nanoseconds since epoch, at submission to the Exchange
+	long long		timestamp;					// Nanoseconds since epoch, at acceptance
+};
+
+// One executed trade between a buyer and a seller
+struct FillRecord {
+	std::uint64_t	sequence;					// Sequence number of the message that crossed the book
+	std::uint64_t	buyer_id;					// Trader::getId() of the buyer
+	std::uint64_t	buy_order_id;
+	std::uint64_t	seller_id;					// Trader::getId() of the seller
+	std::uint64_t	sell_order_id;
+	unsigned int	symbol;						// Index of the stock in the Exchange
+	Ticks			price;						// Trade price, in ticks of the stock
+	long long		quantity;					// Filled quantity
+	long long		timestamp;					// Nanoseconds since epoch, at execution
+};
+
+// One inbound message other than a submission: an edit, a delete, a listing or a halt.
+// These only go to the journal. With the Order records, the journal of an engine holds
+// every message the engine sequenced, without a gap, thus a session can be replayed
+struct MessageRecord {
+	std::uint64_t	sequence;					// Sequence number of the message
+	std::uint64_t	trader_id;					// Trader::getId(), 0 for listings and halts
+	std::uint64_t	order_id;					// Order edited or deleted, 0 for listings and halts
+	unsigned int	symbol;						// Index of the stock in the Exchange
+	unsigned char	type;						// OrderMessage::Type
+	OrderSide		side;
+	Ticks			price;						// New price of a price edit
+	long long		quantity;					// New quantity of a quantity edit
+	long long		timestamp;					// Nanoseconds since epoch, at sequencing
+};
+
+#endif // !RECORDS_HPP
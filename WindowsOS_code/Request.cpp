@@ -9,8 +9,6 @@
 */
 
 #include "Request.hpp"
-#include <chrono>
-#include <random>
 
 //*** Request base class implementation ***//
 
@@ -26,16 +24,22 @@ Request::~Request() = default;
 //*** Getter methods to be inherited in derived classes ***//
 
 // Trade timestamp getter (as a string)
+// The timestamp is only formatted here, when somebody asks for it
 // Return "NULL" if an exception/error/cancellation occurs 
 const std::string Request::getTimestamp() {
-	if (Request::rdata != nullptr) {
-		std::stringstream ss;
-		ss << std::put_time(&Request::rdata->m_timestamp, "%F %T EST");
-		return ss.str();
-	}
+	if (Request::rdata != nullptr)
+		return Clock::format(Request::rdata->m_timestamp);
 	return "NULL";
 }
 
+// Trade timestamp getter, in nanoseconds since epoch
+// Return 0 if an exception/error/cancellation occurs
+const long long Request::getTime() {
+	if (Request::rdata != nullptr)
+		return Request::rdata->m_timestamp;
+	return 0;
+}
+
 // Trading instrument getter as a string (stock name in our example)
 // Return "NULL" if an exception/error/cancellation occurs
 const std::string Request::getInstrument() {
@@ -52,6 +56,14 @@ const std::string Request::getSide() {
 	return "NULL";
 }
 
+// Order type (LIMIT/IOC/FOK/MARKET) getter as a string
+// Return "NULL" if an exception/error/cancellation occurs
+const std::string Request::getType() {
+	if (Request::rdata != nullptr)
+		return Request::rdata->m_type;
+	return "NULL";
+}
+
 // Trade quantity getter
 // Return 0 if an exception/error/cancellation occurs
 const long Request::getQuantity() {
@@ -77,14 +89,54 @@ const Request::DataTuple Request::getData() {
 }
 
 
-const std::string Request::getId() {
+// Request id getter
+// Return 0 if an exception/error/cancellation occurs
+const std::uint64_t Request::getId() {
 	if (Request::rdata != nullptr)
 		return Request::rdata->m_id;
-	else return "NULL";
+	return 0;
+}
+
+// Produces the Order of this request. Side, price and quantity are converted here, once,
+// thus the matching engine never calls back into the Request
+const Order Request::toOrder(std::uint32_t symbol, Cash tick_size) {
+	Order order;
+	if (Request::rdata != nullptr) {
+		order.quantity = Request::rdata->m_quantity;
+		order.side = Request::rdata->m_side == "BUY" ? SIDE_BUY : SIDE_SELL;
+
+		const std::string & type = Request::rdata->m_type;
+		if (type == "IOC")
+			order.type = ORDER_IOC;
+		else if (type == "FOK")
+			order.type = ORDER_FOK;
+		else if (type == "MARKET")
+			order.type = ORDER_MARKET;
+
+		// A market order has no limit price
+		if (order.type != ORDER_MARKET)
+			order.price = to_ticks(Request::rdata->m_price, tick_size);
+	}
+	order.symbol = symbol;
+	return order;
+}
+
+// Order id getter
+// Return 0 if the request was never submitted or if an exception/error/cancellation occurs
+const std::uint64_t Request::getOrderId() {
+	if (Request::rdata != nullptr)
+		return Request::rdata->m_order_id;
+	return 0;
 }
 
 //*** Modifier methods ***//
 
+// Order id setter, called by the Exchange on submission
+void Request::setOrderId(std::uint64_t order_id) {
+	if (Request::rdata != nullptr)
+		Request::rdata->m_order_id = order_id;
+}
+
 // Quantity setter, in case a trade is not completely filled
 void Request::setQuantity(long new_quant) {
 	if (Request::rdata != nullptr) 
@@ -107,7 +159,7 @@ void Request::setPrice(double new_price) {
 
 // Parameter constructor implementation (No need for default constructor, since "default" trades are not defined)
 // Takes Request data as input and instantiates a new request dynamically.
-AutoRequest::AutoRequest(std::string side, std::string instrument, double price, long quantity) {
+AutoRequest::AutoRequest(std::string side, std::string instrument, double price, long quantity, std::string type) {
 	Request::rdata = new RequestData();
 	
 	// Key data
@@ -115,19 +167,13 @@ AutoRequest::AutoRequest(std::string side, std::string instrument, double price,
 	Request::rdata->m_quantity		= quantity;
 	Request::rdata->m_price			= price;
 	Request::rdata->m_side			= side;
+	Request::rdata->m_type			= type;
 	
-	// Timestamp
-	std::time_t t				= std::time(nullptr);
-	Request::rdata->m_timestamp = *std::localtime(&t);	
-
-	std::uniform_int<int> dist(0, 1);
-	std::mt19937 eng;
-	unsigned i = 0;
-	for (; i < 8; ++i) {
-		// Generate pure randomness as per the system clock in every iteration
-		eng.seed(std::chrono::system_clock::now().time_since_epoch().count());
-		rdata->m_id += std::to_string(dist(eng));
-	}
+	// Timestamp, as a raw number: no lock, no formatting
+	Request::rdata->m_timestamp = Clock::now();
+
+	// Ids come from the request id generator, in blocks per thread
+	Request::rdata->m_id		= IdGenerator<Request>::next();
 }
 
 
@@ -159,7 +205,7 @@ AutoRequest::~AutoRequest() {
 
 // ManualRequest Default constructor will instantiate RequestData on the heap, call an init()
 // method that will allow the user SAFELY to select the wanted request values, and if no
-// errors/exceptions/etc. occur, then the constructor will proceed to get the timestamp
+// errors/exceptions/etc. occur, then the constructor will proceed to get the timestamp and the id
 ManualRequest::ManualRequest() {
 	Request::rdata = new RequestData();
 
@@ -168,18 +214,14 @@ ManualRequest::ManualRequest() {
 
 	// If no errors when init
 	if (Request::rdata != nullptr) {
-		// Timestamp
-		std::time_t t				= std::time(nullptr);
-		Request::rdata->m_timestamp = *std::localtime(&t);
-	}	
-
-	std::uniform_int<int> dist(0, 1);
-	std::mt19937 eng;
-	unsigned i = 0;
-	for (; i < 8; ++i) {
-		// Generate pure randomness as per the system clock in every iteration
-		eng.seed(std::chrono::system_clock::now().time_since_epoch().count());
-		rdata->m_id += std::to_string(dist(eng));
+		// Manual requests are limit orders
+		Request::rdata->m_type = "LIMIT";
+
+		// Timestamp, as a raw number: no lock, no formatting
+		Request::rdata->m_timestamp = Clock::now();
+
+		// Ids come from the request id generator, in blocks per thread
+		Request::rdata->m_id = IdGenerator<Request>::next();
 	}
 }
 
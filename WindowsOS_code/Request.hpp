@@ -17,25 +17,27 @@
 // Necessary Standard Lib dependencies
 // Make sure they work under the production OS
 #include <iostream>
-#include <chrono>		// System clock etc.: http://en.cppreference.com/w/cpp/chrono
-#include <ctime>
-#include <iomanip>		// std::put_time, to convert timestamp to string: http://en.cppreference.com/w/cpp/header/iomanip
 #include <string>
-#include <sstream>
 #include <tuple>
 
+#include "Order.hpp"
+#include "IdGenerator.hpp"
+#include "Clock.hpp"
+
 //*** RequestData struct ***//
 
 // Encapsulate all the necessary data for a request + timestamp
 // This struct will be encapsulated below as well. Only used for convenience
 // and intuitive structuring of the parameters
 struct RequestData {
-	std::tm		m_timestamp;		// Timestamp of Request creation
+	long long	m_timestamp;		// Time of Request creation, in nanoseconds (Clock)
 	std::string m_instrument;		// Underlying Instrument
 	std::string m_side;			// Trade side (BUY/SELL)
+	std::string m_type;			// Order type (LIMIT/IOC/FOK/MARKET)
 	long		m_quantity;		// Trade quantity
 	double		m_price;		// Trade price
-	std::string m_id;			// Request id
+	std::uint64_t m_id;			// Request id, unique among the requests of the process
+	std::uint64_t m_order_id;	// Id of the Order made from this request, 0 until submitted
 };
 
 //=========================================================================================
@@ -66,12 +68,24 @@ public:
 	// Getters
 	virtual void				printRequestInfo() = 0;
 	virtual const std::string	getInstrument();
-	virtual const std::string	getTimestamp();
+	virtual const std::string	getTimestamp();	// As text, formatted on every call
+	virtual const long long		getTime();		// In nanoseconds, as taken
 	virtual const long			getQuantity();
 	virtual const double		getPrice();
 	virtual const std::string	getSide();	
+	virtual const std::string	getType();
 	virtual const DataTuple		getData();
-	virtual const std::string	getId();
+	virtual const std::uint64_t	getId();
+
+	// The Exchange books and matches compact Orders, not Requests. A request produces its
+	// Order once, on submission. The Exchange supplies what the request doesn't know:
+	// the interned symbol id and the tick size of the stock. The order id and the trader
+	// are set by the Exchange as well
+	const Order					toOrder(std::uint32_t symbol, Cash tick_size);
+
+	// Id of the last Order the Exchange made from this request. Edits and deletes use it
+	const std::uint64_t			getOrderId();
+	void						setOrderId(std::uint64_t order_id);
 protected:
 	RequestData * rdata;
 private:
@@ -93,8 +107,10 @@ private:
 	// This implementation is for demo only 
 class AutoRequest : public Request {
 public:
-	// The parameter constructor is responsible for the memory allocation of RequestData
-	AutoRequest(std::string side, std::string instrument, double price, long quantity);
+	// The parameter constructor is responsible for the memory allocation of RequestData.
+	// Requests are limit orders unless another type is given. The price of a MARKET
+	// request is ignored
+	AutoRequest(std::string side, std::string instrument, double price, long quantity, std::string type = "LIMIT");
 
 	// Memory management internally! This destructor is responsible for the
 	// memory de-allocation of RequestData.
@@ -0,0 +1,382 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ===============================================
+*
+*	StaticExchange class definition and implementation
+*
+*/
+
+// Multiple inclusion guards to avoid linker errors
+// In case this file is included in multiple source files
+// we want to avoid re-compilations
+#ifndef STATIC_EXCHANGE_HPP
+#define STATIC_EXCHANGE_HPP
+
+#include <array>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "Exchange.hpp"
+
+//*** Compile-time perfect hashing ***//
+
+// Perfect hash of a fixed list of tickers, built by the compiler (hash and displace).
+// Every ticker is hashed once with SymbolTable::hash. The hash picks a bucket, the bucket
+// holds a seed, and the hash mixed with the seed picks the slot of the ticker. The seeds
+// are searched at compile time until no two tickers share a slot, thus a lookup reads one
+// seed and one slot, and compares the ticker found there once: no probing, no chain.
+namespace perfect_hash {
+
+	// Power of two number of slots, at least twice the number of tickers
+	constexpr std::size_t slots_for(std::size_t count) {
+		std::size_t slots = 2;
+		while (slots < 2 * count)
+			slots <<= 1;
+		return slots;
+	}
+
+	// Mixes a seed into a hash (64-bit finalizer of MurmurHash3)
+	constexpr std::uint64_t mix(std::uint64_t h, std::uint32_t seed) {
+		h ^= seed * 0x9E3779B97F4A7C15ULL;
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdULL;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ULL;
+		h ^= h >> 33;
+		return h;
+	}
+
+	constexpr std::size_t length(const char * s) {
+		std::size_t n = 0;
+		while (s[n] != '\0')
+			++n;
+		return n;
+	}
+
+	// True if the first n characters of s are the whole ticker
+	constexpr bool matches(const char * s, std::size_t n, const char * ticker) {
+		std::size_t i = 0;
+		for (; i < n; ++i)
+			if (ticker[i] == '\0' || ticker[i] != s[i])
+				return false;
+		return ticker[n] == '\0';
+	}
+
+	template <std::size_t N>
+	struct Table {
+		static constexpr std::size_t buckets = N;
+		static constexpr std::size_t slots = slots_for(N);
+
+		std::uint32_t	seeds[buckets];		// Seed of every bucket
+		std::uint32_t	ids[slots];			// Id of the ticker in every slot, npos if empty
+		bool			ok;					// False if the tickers are not unique
+
+		constexpr std::size_t bucket(std::uint64_t h) const { return (std::size_t)((h >> 32) % buckets); }
+		constexpr std::size_t slot(std::uint64_t h) const { return (std::size_t)(mix(h, seeds[bucket(h)]) & (slots - 1)); }
+	};
+
+	// Builds the table. The fullest buckets are placed first, while most slots are free
+	template <std::size_t N>
+	constexpr Table<N> build(const char * const (&tickers)[N]) {
+		Table<N> table{};
+		table.ok = true;
+
+		std::size_t i = 0, j = 0;
+		for (i = 0; i < Table<N>::slots; ++i)
+			table.ids[i] = SymbolTable::npos;
+
+		// Hash every ticker once and sort the tickers by bucket (counting sort)
+		std::uint64_t hashes[N] = {};
+		std::size_t count[N + 1] = {};
+		std::size_t order[N] = {};
+		std::size_t largest = 0;
+		for (i = 0; i < N; ++i) {
+			hashes[i] = SymbolTable::hash(tickers[i], length(tickers[i]));
+			if (++count[table.bucket(hashes[i]) + 1] > largest)
+				largest = count[table.bucket(hashes[i]) + 1];
+		}
+		std::size_t first[N + 1] = {};
+		for (i = 0; i < N; ++i)
+			first[i + 1] = first[i] + count[i + 1];
+		std::size_t next[N] = {};
+		for (i = 0; i < N; ++i) {
+			std::size_t b = table.bucket(hashes[i]);
+			order[first[b] + next[b]++] = i;
+		}
+
+		// A ticker listed twice lands twice in the same bucket, and no seed can separate it
+		for (i = 0; i < N; ++i)
+			for (j = i + 1; j < first[table.bucket(hashes[order[i]]) + 1]; ++j)
+				if (hashes[order[i]] == hashes[order[j]] && matches(tickers[order[i]], length(tickers[order[i]]), tickers[order[j]])) {
+					table.ok = false;
+					return table;
+				}
+
+		// Find a seed for every bucket that sends its tickers to free, distinct slots
+		std::size_t taken[N] = {};
+		std::size_t size = largest;
+		for (; size > 0; --size) {
+			std::size_t b = 0;
+			for (; b < N; ++b) {
+				if (count[b + 1] != size)
+					continue;
+
+				std::uint32_t seed = 1;
+				for (;; ++seed) {
+					if (seed == 0) {
+						table.ok = false;
+						return table;
+					}
+
+					bool fits = true;
+					std::size_t k = 0;
+					for (; k < size && fits; ++k) {
+						std::size_t slot = (std::size_t)(mix(hashes[order[first[b] + k]], seed) & (Table<N>::slots - 1));
+						if (table.ids[slot] != SymbolTable::npos)
+							fits = false;
+						for (j = 0; j < k && fits; ++j)
+							if (taken[j] == slot)
+								fits = false;
+						taken[k] = slot;
+					}
+					if (fits)
+						break;
+				}
+
+				table.seeds[b] = seed;
+				std::size_t k = 0;
+				for (; k < size; ++k)
+					table.ids[taken[k]] = (std::uint32_t)order[first[b] + k];
+			}
+		}
+		return table;
+	}
+}
+
+//*** StaticExchange class ***//
+
+// Exchange for a venue whose stocks are known at compile time. The universe is a type
+// that lists the tickers, in id order:
+//
+//		struct Nasdaq5 { static constexpr const char* symbols[] = { "GOOGL", "AMZN", "TSLA", "DIS", "BABA" }; };
+//		StaticExchange<Nasdaq5> NYSE;
+//		constexpr std::uint32_t GOOGL = StaticExchange<Nasdaq5>::id("GOOGL");
+//
+// The ticker to id resolution is a perfect hash built by the compiler, and the nodes of
+// the stocks are a std::array laid out contiguously inside the Exchange. A request
+// addressed by id makes no lookup at all (the id is a constant), and a request addressed
+// by ticker makes one hash and one compare. Tickers that are listed twice don't compile.
+// The matching engines, the ingress rings and the books are the same as the Exchange's.
+// The universe can't change, thus there are no intraday listings or halts.
+// This is a template, thus the implementation lives in the header as well
+template <typename Universe>
+class StaticExchange {
+public:
+	// Number of stocks of the universe
+	static constexpr std::size_t size = sizeof(Universe::symbols) / sizeof(Universe::symbols[0]);
+
+	// Id of a ticker, or SymbolTable::npos if it is not listed. Usable in constant expressions
+	static constexpr std::uint32_t id(const char * ticker) {
+		return id(ticker, perfect_hash::length(ticker));
+	}
+
+	static constexpr std::uint32_t id(const char * ticker, std::size_t length) {
+		std::uint32_t found = m_table.ids[m_table.slot(SymbolTable::hash(ticker, length))];
+		return found != SymbolTable::npos && perfect_hash::matches(ticker, length, Universe::symbols[found]) ? found : SymbolTable::npos;
+	}
+
+	static inline std::uint32_t id(const std::string & ticker) {
+		return id(ticker.data(), ticker.size());
+	}
+
+	// Ticker of an id
+	static constexpr const char * name(std::uint32_t id) {
+		return Universe::symbols[id];
+	}
+
+	// Opens the Exchange with the given settings. The symbols of the configuration are
+	// ignored, the universe lists the stocks
+	StaticExchange(const ExchangeConfig & config = ExchangeConfig()) : m_next_order_id(1) {
+		std::uint32_t i = 0;
+		for (; i < (std::uint32_t)size; ++i) {
+			auto custom = config.tick_sizes.find(Universe::symbols[i]);
+			m_nodes[i].stock = Universe::symbols[i];
+			m_nodes[i].id = i;
+			m_nodes[i].tick_size = make_tick_size(m_nodes[i].stock, custom != config.tick_sizes.end() ? custom->second : config.tick_size);
+		}
+
+		m_engines.workers = config.workers == 0 ? 1 : config.workers;
+		m_engines.engines = new MatchingEngine*[m_engines.workers];
+		std::size_t e = 0;
+		for (; e < m_engines.workers; ++e)
+			m_engines.engines[e] = make_engine(config, e);
+
+		for (i = 0; i < (std::uint32_t)size; ++i)
+			engine(i)->pin(&m_nodes[i]);
+		for (e = 0; e < m_engines.workers; ++e)
+			m_engines.engines[e]->start();
+	}
+
+	// Closes the Exchange: the engines finish, then the nodes give their entries back to
+	// the engines' pools, then the engines go (see Engines)
+	~StaticExchange() {
+		std::size_t e = 0;
+		for (; e < m_engines.workers; ++e)
+			m_engines.engines[e]->stop();
+	}
+
+	// Waits until every message enqueued before the call has been applied and matched
+	void flush() {
+		std::size_t e = 0;
+		for (; e < m_engines.workers; ++e)
+			m_engines.engines[e]->flush();
+	}
+
+	// Submits a trade for the stock with the given id, with no lookup. The request is
+	// validated like the Exchange's (see prepare_order)
+	inline SubmitStatus submit_trade(std::uint32_t stock, const TradeNode & tn) {
+		if (stock >= size) {
+			report_reject(tn.trader, 0, tn.request->getId(), stock, tn.request->getSide(), REJECT_UNKNOWN_STOCK);
+			return REJECTED;
+		}
+
+		OrderMessage msg;
+		if (!prepare_order(m_nodes[stock], tn, msg))
+			return REJECTED;
+
+		// A request that doesn't make it into the ring gives its reservation and its order id back
+		msg.order.id = m_next_order_id.fetch_add(1, std::memory_order_relaxed);
+		tn.request->setOrderId(msg.order.id);
+		SubmitStatus status = engine(stock)->enqueue(msg);
+		if (status == BACKPRESSURE) {
+			tn.trader->release(reservation(msg.order, msg.node->tick_size, msg.order.quantity));
+			tn.request->setOrderId(0);
+		}
+		return status;
+	}
+
+	// Submits a trade for the stock of its request, resolved by the perfect hash
+	inline SubmitStatus submit_trade(const TradeNode & tn) {
+		std::uint32_t stock = id(tn.request->getInstrument());
+		if (stock == SymbolTable::npos)
+			std::cerr << "Bad trade request! Stock doesn't exist.\n";
+		return submit_trade(stock, tn);
+	}
+
+	// Edit trade
+	SubmitStatus edit_trade_price(Trader * t, Request * r, std::string side, std::uint32_t stock, double new_price) {
+		return modify(message(OrderMessage::EDIT_PRICE, t, r), side, stock, new_price);
+	}
+
+	SubmitStatus edit_trade_quantity(Trader * t, Request * r, std::string side, std::uint32_t stock, long quantity) {
+		OrderMessage msg = message(OrderMessage::EDIT_QUANTITY, t, r);
+		msg.order.quantity = quantity;
+		return modify(msg, side, stock);
+	}
+
+	// Delete trade
+	SubmitStatus delete_trade(Trader * t, Request * r, std::string side, std::uint32_t stock) {
+		return modify(message(OrderMessage::DELETE, t, r), side, stock);
+	}
+
+	// The same, with the stock resolved by the perfect hash
+	SubmitStatus edit_trade_price(Trader * t, Request * r, std::string side, std::string instrument, double new_price) {
+		return edit_trade_price(t, r, side, id(instrument), new_price);
+	}
+
+	SubmitStatus edit_trade_quantity(Trader * t, Request * r, std::string side, std::string instrument, long quantity) {
+		return edit_trade_quantity(t, r, side, id(instrument), quantity);
+	}
+
+	SubmitStatus delete_trade(Trader * t, Request * r, std::string side, std::string instrument) {
+		return delete_trade(t, r, side, id(instrument));
+	}
+
+	// Return the raw Order and Fill book records, gathered engine by engine
+	const std::vector<OrderRecord> getOrderRecords() {
+		std::vector<OrderRecord> book;
+		std::size_t e = 0;
+		for (; e < m_engines.workers; ++e)
+			m_engines.engines[e]->collectOrderBook(book);
+		return book;
+	}
+
+	const std::vector<FillRecord> getFillRecords() {
+		std::vector<FillRecord> book;
+		std::size_t e = 0;
+		for (; e < m_engines.workers; ++e)
+			m_engines.engines[e]->collectFillBook(book);
+		return book;
+	}
+
+	// Market data of the stock with the given id, as last published by its engine. Lock-free
+	inline Quote get_quote(std::uint32_t stock) const {
+		return m_nodes[stock].quote.read();
+	}
+
+	inline BookDepth get_depth(std::uint32_t stock) const {
+		return m_nodes[stock].depth.read();
+	}
+
+	// Tick size of a stock, in minor units. Converts the ticks of the records to prices
+	Cash tick_size(std::uint32_t stock) const {
+		return m_nodes[stock].tick_size;
+	}
+
+private:
+	// Owns the engines. It is declared before the nodes, thus it is destroyed after them
+	// and the ladders can give their entries back to the pools first
+	struct Engines {
+		MatchingEngine**	engines;
+		std::size_t			workers;
+
+		Engines() : engines(nullptr), workers(0) {}
+		~Engines() {
+			std::size_t e = 0;
+			for (; e < workers; ++e)
+				delete engines[e];
+			delete[] engines;
+		}
+	};
+
+	static constexpr perfect_hash::Table<size> m_table = perfect_hash::build(Universe::symbols);
+	static_assert(m_table.ok, "The tickers of a universe must be unique");
+
+	Engines										m_engines;		// Stock i is pinned to engine i % workers
+	std::array<ExchangeNode, size>				m_nodes;		// Stock i is m_nodes[i]
+	std::atomic<std::uint64_t>					m_next_order_id;
+
+	inline MatchingEngine* engine(std::uint32_t stock) {
+		return m_engines.engines[stock % m_engines.workers];
+	}
+
+	// Edits and deletes address the Order the Exchange made from the request on submission
+	static OrderMessage message(OrderMessage::Type type, Trader * t, Request * r) {
+		OrderMessage msg;
+		msg.type = type;
+		msg.order.id = r->getOrderId();
+		msg.order.trader = t;
+		return msg;
+	}
+
+	// Validates an edit or delete like the Exchange's (see prepare_edit) and routes it
+	SubmitStatus modify(OrderMessage msg, const std::string & side, std::uint32_t stock, double new_price = 0.0) {
+		if (stock >= size) {
+			report_reject(msg.order.trader, msg.order.id, 0, stock, side, REJECT_UNKNOWN_STOCK);
+			return REJECTED;
+		}
+
+		if (!prepare_edit(m_nodes[stock], msg, side, new_price))
+			return REJECTED;
+		return engine(stock)->enqueue(msg);
+	}
+
+	// Avoid accidental or intentional copies and clones of the Exchange
+	StaticExchange(const StaticExchange&);
+	StaticExchange& operator=(const StaticExchange&);
+};
+
+#endif // !STATIC_EXCHANGE_HPP
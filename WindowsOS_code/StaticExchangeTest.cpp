@@ -0,0 +1,118 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	Testing the StaticExchange class
+*
+*/
+
+// Import the necessary files
+#include <iostream>
+#include "StaticExchange.hpp"
+
+// Universe of the tests, in id order
+struct Nasdaq5 { static constexpr const char* symbols[] = { "GOOGL", "AMZN", "TSLA", "DIS", "BABA" }; };
+typedef StaticExchange<Nasdaq5> Nasdaq;
+
+// Ids resolved by the compiler. These lines don't compile if the perfect hash is wrong
+constexpr std::uint32_t GOOGL = Nasdaq::id("GOOGL");
+constexpr std::uint32_t DIS = Nasdaq::id("DIS");
+static_assert(GOOGL == 0 && DIS == 3 && Nasdaq::id("BABA") == 4, "Tickers resolve to their listing order");
+static_assert(Nasdaq::id("IBM") == SymbolTable::npos && Nasdaq::id("GOOG") == SymbolTable::npos, "Unknown tickers don't resolve");
+
+int main() {
+
+	std::cout << "*** Testing StaticExchange functionality ***\n\n";
+	std::cout << std::boolalpha;
+
+	// Test 1: Known tickers resolve to constant ids, at compile time or from a string
+	std::cout << "*** Test 1:\n\n";
+
+	std::cout << "Number of stocks: " << Nasdaq::size << " (expected 5)\n";
+	std::cout << "Ids of GOOGL, DIS: " << GOOGL << ", " << DIS << " (expected 0, 3)\n";
+	std::cout << "Id of TSLA from a string: " << Nasdaq::id(std::string("TSLA")) << " (expected 2)\n";
+	std::cout << "Name of id 1: " << Nasdaq::name(1) << " (expected AMZN)\n\n\n";
+
+	// Success!
+
+	// Test 2: Unknown tickers and ids are rejected at the door and reported to the trader
+	std::cout << "*** Test 2:\n\n";
+
+	Trader maker(1'000'000), taker(1'000'000);
+	ExecutionReports reports;
+	maker.subscribe(&reports);
+	{
+		Nasdaq NYSE;
+
+		AutoRequest unknown("BUY", "NVDA", 10.0, 1);
+		SubmitStatus by_ticker = NYSE.submit_trade(TradeNode(&maker, &unknown));
+		SubmitStatus by_id = NYSE.submit_trade(Nasdaq::size, TradeNode(&maker, &unknown));
+		SubmitStatus deleted = NYSE.delete_trade(&maker, &unknown, "BUY", "NVDA");
+
+		long rejects = 0;
+		ExecutionReport report;
+		while (reports.poll(report))
+			if (report.type == REPORT_REJECT && report.reason == REJECT_UNKNOWN_STOCK)
+				++rejects;
+
+		std::cout << "Submitted by ticker: " << (by_ticker == REJECTED) << ", by id: " << (by_id == REJECTED)
+			<< ", delete: " << (deleted == REJECTED) << " (expected true, true, true)\n";
+		std::cout << "Unknown stock rejects reported: " << rejects << " (expected 3)\n";
+		std::cout << "Maker's cash all free: " << (maker.buyingPower() == maker.cash()) << " (expected true)\n\n\n";
+	}
+
+	// Success!
+
+	// Test 3: Submit, edit and delete end to end, by id and by ticker. The requests are
+	// checked like the Exchange's: an off-tick or a negative price edit is rejected and the
+	// order keeps its price
+	std::cout << "*** Test 3:\n\n";
+	{
+		ExchangeConfig config;
+		config.workers = 2;
+		Nasdaq NYSE(config);
+
+		AutoRequest bid("BUY", "GOOGL", 100.0, 10);
+		AutoRequest ask("SELL", "DIS", 50.0, 10);
+		SubmitStatus bid_status = NYSE.submit_trade(GOOGL, TradeNode(&maker, &bid));
+		SubmitStatus ask_status = NYSE.submit_trade(TradeNode(&maker, &ask));
+
+		SubmitStatus off_tick = NYSE.edit_trade_price(&maker, &bid, "BUY", GOOGL, 101.005);
+		SubmitStatus repriced = NYSE.edit_trade_price(&maker, &bid, "BUY", "GOOGL", 101.0);
+		SubmitStatus resized = NYSE.edit_trade_quantity(&maker, &bid, "BUY", GOOGL, 4);
+		SubmitStatus deleted = NYSE.delete_trade(&maker, &ask, "SELL", DIS);
+		NYSE.flush();
+
+		Quote googl = NYSE.get_quote(GOOGL);
+		Quote dis = NYSE.get_quote(DIS);
+		std::cout << "Submitted by id and by ticker: " << (bid_status == SUBMITTED && ask_status == SUBMITTED) << " (expected true)\n";
+		std::cout << "Off-tick edit: " << (off_tick == REJECTED) << ", edits and delete: "
+			<< (repriced == SUBMITTED && resized == SUBMITTED && deleted == SUBMITTED) << " (expected true, true)\n";
+		std::cout << "GOOGL bid: " << to_price(googl.bid.price, NYSE.tick_size(GOOGL)) << " x " << googl.bid.quantity << " (expected 101 x 4)\n";
+		std::cout << "DIS ask quantity: " << dis.ask.quantity << " (expected 0)\n";
+
+		// A negative price would need less than the order reserved and free the difference
+		Cash buying_power = maker.buyingPower();
+		SubmitStatus negative = NYSE.edit_trade_price(&maker, &bid, "BUY", GOOGL, -101.0);
+		NYSE.flush();
+		std::cout << "Negative price edit: " << (negative == REJECTED) << ", buying power unchanged: " << (maker.buyingPower() == buying_power)
+			<< " (expected true, true)\n";
+
+		// Take the bid
+		AutoRequest hit("SELL", "GOOGL", 101.0, 4);
+		NYSE.submit_trade(GOOGL, TradeNode(&taker, &hit));
+		NYSE.flush();
+
+		std::cout << "Orders: " << NYSE.getOrderRecords().size() << ", fills: " << NYSE.getFillRecords().size() << " (expected 3, 1)\n";
+		std::cout << "Maker's cash: " << (long long)to_dollars(maker.cash()) << ", taker's cash: " << (long long)to_dollars(taker.cash()) << " (expected 999596, 1000404)\n";
+		std::cout << "Maker's cash all free: " << (maker.buyingPower() == maker.cash()) << " (expected true)\n\n\n";
+	}
+
+	maker.subscribe(nullptr);
+
+	// Success!
+
+	return 0;
+}
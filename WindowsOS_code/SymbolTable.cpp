@@ -0,0 +1,104 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	SymbolTable class implementation
+*
+*/
+
+#include "SymbolTable.hpp"
+
+#include <fstream>
+
+//*** Constructor and Destructor ***//
+
+// Number of slots for a number of tickers: a power of two, at most a quarter full
+static std::size_t slots_for(std::size_t capacity) {
+	std::size_t slots = 16;
+	while (slots < 4 * capacity)
+		slots <<= 1;
+	return slots;
+}
+
+// The constructor allocates an empty table
+SymbolTable::SymbolTable(std::size_t capacity) : m_slots(nullptr), m_mask(0) {
+	allocate(slots_for(capacity));
+	m_names.reserve(capacity);
+}
+
+// The destructor reclaims the slots
+SymbolTable::~SymbolTable() {
+	delete[] m_slots;
+}
+
+//*** Modifiers ***//
+
+// Interns a ticker. The table doubles when it gets more than a quarter full,
+// thus lookups stay at one probe on average
+std::uint32_t SymbolTable::intern(const std::string & symbol) {
+	std::uint32_t id = find(symbol);
+	if (id != npos)
+		return id;
+
+	if (symbol.empty()) {
+		std::cerr << "Bad symbol! Empty tickers can't be listed.\n";
+		return npos;
+	}
+
+	id = (std::uint32_t)m_names.size();
+	m_names.push_back(symbol);
+
+	if (4 * m_names.size() > m_mask + 1) {
+		delete[] m_slots;
+		allocate(2 * (m_mask + 1));
+		std::uint32_t i = 0;
+		for (; i < (std::uint32_t)m_names.size(); ++i)
+			insert_slot(hash(m_names[i].data(), m_names[i].size()), i);
+	}
+	else
+		insert_slot(hash(symbol.data(), symbol.size()), id);
+	return id;
+}
+
+// Loads one ticker per line. Blank lines and surrounding spaces are ignored
+bool SymbolTable::load(const std::string & path) {
+	std::ifstream file(path);
+	if (!file) {
+		std::cerr << "Cannot read the symbol file " << path << "!\n";
+		return false;
+	}
+
+	std::string line;
+	while (std::getline(file, line)) {
+		std::size_t begin = line.find_first_not_of(" \t\r");
+		if (begin == std::string::npos)
+			continue;
+		std::size_t end = line.find_last_not_of(" \t\r");
+		intern(line.substr(begin, end - begin + 1));
+	}
+	return true;
+}
+
+//*** Private methods ***//
+
+// Allocates an empty array of slots
+void SymbolTable::allocate(std::size_t slots) {
+	m_slots = new Slot[slots];
+	m_mask = slots - 1;
+	std::size_t i = 0;
+	for (; i < slots; ++i) {
+		m_slots[i].hash = 0;
+		m_slots[i].id = npos;
+	}
+}
+
+// Places an id at the first free slot of its probe sequence
+void SymbolTable::insert_slot(std::uint64_t h, std::uint32_t id) {
+	std::size_t i = (std::size_t)h & m_mask;
+	while (m_slots[i].id != npos)
+		i = (i + 1) & m_mask;
+	m_slots[i].hash = h;
+	m_slots[i].id = id;
+}
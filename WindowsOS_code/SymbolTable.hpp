@@ -0,0 +1,101 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	SymbolTable class definition
+*
+*/
+
+// Multiple inclusion guards to avoid linker errors
+// In case this file is included in multiple source files
+// we want to avoid re-compilations
+#ifndef SYMBOL_TABLE_HPP
+#define SYMBOL_TABLE_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+//*** SymbolTable class ***//
+
+// Registry of the listed instruments. Every ticker is interned to a dense integer id
+// (0, 1, 2, ... in listing order), which indexes the Exchange's instruments; past the
+// front door the Exchange and the matching engines only use the id.
+// Tickers are found through an open-addressing hash table (FNV-1a hash, linear probing)
+// kept at most a quarter full, and every slot stores the full hash next to the id, thus a
+// lookup is usually a single probe and only compares characters on a hash match.
+// The table is filled once, when the Exchange opens, and scales to tens of thousands
+// of instruments.
+class SymbolTable {
+public:
+	// Id returned for unknown tickers
+	static const std::uint32_t npos = 0xFFFFFFFFu;
+
+	// The constructor reserves room for the given number of tickers
+	SymbolTable(std::size_t capacity = 64);
+	~SymbolTable();
+
+	// Adds a ticker and returns its id. A listed ticker keeps its id
+	std::uint32_t intern(const std::string & symbol);
+
+	// Adds the tickers of a text file, one per line. Returns false if the file can't be read
+	bool load(const std::string & path);
+
+	// Returns the id of a ticker, or npos if it is not listed
+	inline std::uint32_t find(const std::string & symbol) const {
+		std::uint64_t h = hash(symbol.data(), symbol.size());
+		std::size_t i = (std::size_t)h & m_mask;
+		for (;; i = (i + 1) & m_mask) {
+			const Slot & slot = m_slots[i];
+			if (slot.id == npos)
+				return npos;
+			if (slot.hash == h && m_names[slot.id] == symbol)
+				return slot.id;
+		}
+	}
+
+	// Ticker of an id
+	inline const std::string & name(std::uint32_t id) const {
+		return m_names[id];
+	}
+
+	// Number of listed tickers
+	inline std::size_t size() const {
+		return m_names.size();
+	}
+
+	// 64-bit FNV-1a: one multiply per character, good spread for short tickers.
+	// It is constexpr, thus compile-time universes hash their tickers the same way
+	static constexpr std::uint64_t hash(const char * data, std::size_t length) {
+		std::uint64_t h = 14695981039346656037ULL;
+		std::size_t i = 0;
+		for (; i < length; ++i) {
+			h ^= (unsigned char)data[i];
+			h *= 1099511628211ULL;
+		}
+		return h;
+	}
+
+private:
+	struct Slot {
+		std::uint64_t	hash;		// Full hash of the ticker
+		std::uint32_t	id;			// npos if the slot is empty
+	};
+
+	Slot*						m_slots;
+	std::size_t					m_mask;		// Number of slots - 1
+	std::vector<std::string>	m_names;	// Id -> ticker
+
+	void allocate(std::size_t slots);
+	void insert_slot(std::uint64_t h, std::uint32_t id);
+
+	// No copies of the registry
+	SymbolTable(const SymbolTable &);
+	SymbolTable& operator=(const SymbolTable &);
+};
+
+#endif // !SYMBOL_TABLE_HPP
@@ -0,0 +1,90 @@
+/*
+*	© Superharmonic Technologies
+*	Pavlos Sakoglou
+*
+*  ================================================
+*
+*	Testing the SymbolTable class
+*
+*/
+
+// Import the necessary files
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include "SymbolTable.hpp"
+
+int main() {
+
+	std::cout << "*** Testing SymbolTable functionality ***\n\n";
+
+	// Test 1: Tickers are interned to dense ids in listing order, and a listed ticker
+	// keeps its id instead of being listed twice
+	std::cout << "*** Test 1:\n\n";
+	SymbolTable table(4);
+
+	std::cout << "Id of GOOGL: " << table.intern("GOOGL") << " (expected 0)\n";
+	std::cout << "Id of AMZN: " << table.intern("AMZN") << " (expected 1)\n";
+	std::cout << "Id of GOOGL interned again: " << table.intern("GOOGL") << " (expected 0)\n";
+	std::cout << "Number of tickers: " << table.size() << " (expected 2)\n";
+	std::cout << "Name of id 1: " << table.name(1) << " (expected AMZN)\n\n\n";
+
+	// Success!
+
+	// Test 2: Unknown and empty tickers. find() returns npos and lists nothing
+	std::cout << "*** Test 2:\n\n";
+
+	std::cout << std::boolalpha;
+	std::cout << "Is TSLA npos? " << (table.find("TSLA") == SymbolTable::npos) << " (expected true)\n";
+	std::cout << "Is GOOG npos? " << (table.find("GOOG") == SymbolTable::npos) << " (expected true)\n";
+	std::uint32_t empty = table.intern("");
+	std::cout << "Is the empty ticker rejected? " << (empty == SymbolTable::npos) << " (expected true, with an error message above)\n";
+	std::cout << "Number of tickers: " << table.size() << " (expected 2)\n\n\n";
+
+	// Success!
+
+	// Test 3: Grow past the initial capacity. The table rehashes and every ticker keeps
+	// the id it was given
+	std::cout << "*** Test 3:\n\n";
+
+	const std::uint32_t count = 1000;
+	std::uint32_t i = 2;
+	for (; i < count; ++i)
+		table.intern("SYM" + std::to_string(i));
+
+	bool found = table.find("GOOGL") == 0 && table.find("AMZN") == 1;
+	for (i = 2; i < count; ++i)
+		if (table.find("SYM" + std::to_string(i)) != i || table.name(i) != "SYM" + std::to_string(i))
+			found = false;
+
+	std::cout << "Number of tickers: " << table.size() << " (expected " << count << ")\n";
+	std::cout << "Every ticker found with its id: " << found << " (expected true)\n";
+	std::cout << "Is SYM1000 npos? " << (table.find("SYM1000") == SymbolTable::npos) << " (expected true)\n\n\n";
+
+	// Success!
+
+	// Test 4: Load a file. Blank lines and surrounding spaces are skipped, and tickers
+	// already listed keep their ids
+	std::cout << "*** Test 4:\n\n";
+
+	const char * path = "SymbolTableTest.txt";
+	std::ofstream file(path);
+	file << "GOOGL\n  TSLA \n\n\tDIS\r\nAMZN\n   \nBABA";
+	file.close();
+
+	SymbolTable loaded;
+	loaded.intern("AMZN");
+	std::cout << "File loaded? " << loaded.load(path) << " (expected true)\n";
+	std::cout << "Number of tickers: " << loaded.size() << " (expected 5)\n";
+	std::cout << "Ids of AMZN, GOOGL, TSLA, DIS, BABA: " << loaded.find("AMZN") << ", " << loaded.find("GOOGL") << ", "
+		<< loaded.find("TSLA") << ", " << loaded.find("DIS") << ", " << loaded.find("BABA") << " (expected 0, 1, 2, 3, 4)\n";
+	std::remove(path);
+
+	bool missing = loaded.load(path);
+	std::cout << "Missing file loaded? " << missing << " (expected false, with an error message above)\n";
+	std::cout << "Number of tickers: " << loaded.size() << " (expected 5)\n\n\n";
+
+	// Success!
+
+	return 0;
+}
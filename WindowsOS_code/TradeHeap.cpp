@@ -14,7 +14,7 @@
 
 // Default constructor allocates on the heap and creates the 
 // heap array of a default size. Initializes index to zero
-TradeHeap::TradeHeap() : m_size(default_size), m_index(0) {
+TradeHeap::TradeHeap() : m_size(default_size), m_index(0), m_sequence(0) {
 	m_trades = new TradeNode[m_size];
 }
 
@@ -28,9 +28,10 @@ std::size_t TradeHeap::default_size = 10;
 TradeHeap::TradeHeap(const TradeHeap & th) {
 	m_size = th.m_size;
 	m_index = th.m_index;
+	m_sequence = th.m_sequence;
 	m_trades = new TradeNode[m_size];
 	unsigned i = 0;
-	for (; i <= m_index; ++i)
+	for (; i < m_index; ++i)
 		m_trades[i] = th.m_trades[i];
 }
 
@@ -78,29 +79,30 @@ bool TradeHeap::empty() {
 
 //*** Resize methods ***//
 
+// Moves the elements to a new array of the given capacity. The elements are
+// copied once, straight into the new array, and the old array is released with delete[]
+void TradeHeap::resize(std::size_t new_size) {
+	TradeNode* trades = new TradeNode[new_size];
+	unsigned i = 0;
+	for (; i < m_index; ++i)
+		trades[i] = m_trades[i];
+	delete[] m_trades;
+	m_trades = trades;
+	m_size = new_size;
+}
+
 // Expand method re-allocates memory dynamically as per 
 // the underlying rule
 void TradeHeap::expand() {
-	TradeHeap temp(*this);
-	m_size += m_size / 3;
-	delete m_trades;
-	m_trades = new TradeNode[m_size];
-	unsigned i = 0;
-	for (; i < m_index; ++i)
-		m_trades[i] = temp.m_trades[i];
+	resize(m_size + m_size / 3);
 }
 
 // Shrink method re-allocates memory dynamically as per 
 // the underlying rule
 void TradeHeap::shrink() {
 	if (m_size <= default_size) return;
-	TradeHeap temp(*this);
-	m_size = (m_size <= default_size) ? default_size : (2 * m_size / 3);
-	delete m_trades;
-	m_trades = new TradeNode[m_size];
-	unsigned i = 0;
-	for (; i < m_index; ++i)
-		m_trades[i] = temp.m_trades[i];
+	std::size_t new_size = 2 * m_size / 3;
+	resize(new_size < default_size ? default_size : new_size);
 }
 
 // Re-sort method for modified contents
@@ -111,17 +113,17 @@ void TradeHeap::sort() {
 	unsigned i = 0;
 	for (; i < m_index; ++i) {
 
-		double max_price = m_trades[i].request->getPrice();
+		Ticks max_price = m_trades[i].price;
 		unsigned max_index = i;
 
 		unsigned j = i + 1;
 		for (; j < m_index; ++j) {
 
-			if (m_trades[i].request->getPrice() == m_trades[j].request->getPrice())
+			if (m_trades[i].price == m_trades[j].price)
 				continue;
 
-			if (m_trades[i].request->getPrice() < m_trades[j].request->getPrice()) {
-				max_price = m_trades[j].request->getPrice();
+			if (m_trades[i].price < m_trades[j].price) {
+				max_price = m_trades[j].price;
 				max_index = j;
 			}
 		}
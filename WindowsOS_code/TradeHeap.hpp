@@ -19,25 +19,29 @@
 //	2) Request class
 #include "Trader.hpp"
 #include "Request.hpp"
+#include "FixedPoint.hpp"
 
 #include <iostream>
-#include <chrono>	// System clock
 
 //*** TradeNode data structure ***//
 
 // This data structure holds the trading information of a trade
 // and will be treated as a trading entiry from the exchange and the
-// matching engine
+// matching engine. The price of the request is copied in integer ticks, thus
+// sorting and matching compare integers and never call into the Request
 struct TradeNode {
 	Trader*		trader;			// Pointer to a Trader instance to be determined
 	Request*	request;		// Pointer to a trading Request instance
-	long long	submit_id;		// Timestamp of filing a request in the exchange
+	long long	submit_id;		// Sequence number of filing a request in the heap
+	Ticks		price;			// Price of the request, in ticks of its instrument
 
 	// Default constructor sets the pointers to nullptr, and the id to -1
-	TradeNode() : trader(nullptr), request(nullptr), submit_id(-1) {}
+	TradeNode() : trader(nullptr), request(nullptr), submit_id(-1), price(0) {}
 
-	// Parameter constructor for convenience
-	TradeNode(Trader * t, Request * r) : trader(t), request(r), submit_id(-1) {}
+	// Parameter constructor for convenience. The price is converted with the default
+	// tick size, the Exchange converts it again with the tick size of the instrument
+	TradeNode(Trader * t, Request * r) : trader(t), request(r), submit_id(-1),
+		price(r == nullptr ? 0 : to_ticks(r->getPrice(), default_tick_size)) {}
 };
 
 //*** TradeHeap class ***//
@@ -125,7 +129,7 @@ public:
 
 		// Case heap is empty
 		if (m_index == 0) {
-			trn.submit_id = std::chrono::system_clock::now().time_since_epoch().count();
+			trn.submit_id = ++m_sequence;
 			m_trades[m_index] = trn;
 			++m_index;
 			return;
@@ -137,20 +141,20 @@ public:
 		if ((double)m_index >= 0.8 * (double)m_size) 
 			expand();
 		
-		// Store input price locally to avoid repeated calls that would drop performance
-		double input_price = trn.request->getPrice();
+		// Prices are integer ticks, thus equal prices compare exactly
+		Ticks input_price = trn.price;
 
 		// Iterate the heap to find the right index to push the object
 		unsigned i = 0;
 		for (; i < m_index; ++i) {
-			double index_price = m_trades[i].request->getPrice();
+			Ticks index_price = m_trades[i].price;
 			if (index_price <= input_price) 
 				break;
 		}
 
 		// Case where input has lowest price
 		if (i == m_index) {
-			trn.submit_id = std::chrono::system_clock::now().time_since_epoch().count();
+			trn.submit_id = ++m_sequence;
 			m_trades[m_index] = trn;
 			++m_index;
 			return;
@@ -158,12 +162,12 @@ public:
 
 		// If two or more keys have the same value (requests with same price)
 		// keep iterating until you find the first smaller key
-		if (m_trades[i].request->getPrice() == input_price && i < m_index) {
+		if (m_trades[i].price == input_price && i < m_index) {
 			do {
 				++i;
 				if (i == m_index)
 					break;
-			} while (m_trades[i].request->getPrice() == input_price);
+			} while (m_trades[i].price == input_price);
 		}
 
 		// Insert in the right place
@@ -172,7 +176,7 @@ public:
 			m_trades[j] = m_trades[j - 1];
 		}
 		m_trades[j] = m_trades[i];
-		trn.submit_id = std::chrono::system_clock::now().time_since_epoch().count();
+		trn.submit_id = ++m_sequence;
 		m_trades[i] = trn;
 		++m_index;
 		return;
@@ -183,6 +187,7 @@ private:
 	TradeNode*			m_trades;	// The heap (dynamic descending array)
 	std::size_t			m_size;		// Capacity of heap
 	unsigned int		m_index;	// Index (number of elements)
+	long long			m_sequence;	// Last submit_id given. Gap-free, unlike a clock, thus ties never reorder
 
 	static std::size_t	default_size;	// Default initial capacity for all heaps
 
@@ -191,6 +196,7 @@ private:
 	// only used when and if necessary
 	void expand();
 	void shrink();
+	void resize(std::size_t new_size);
 
 	// To avoid security loopholes, we set the assignment operator as private
 	TradeHeap& operator=(const TradeHeap & th);
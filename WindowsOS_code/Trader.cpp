@@ -10,125 +10,200 @@
 
 #include "Trader.hpp"
 
-#include <chrono>	// For random generation
-#include <random>	// For id generation
-
 //*** Trader interface implementation ***//
 
-// Parameter constructor to initialize the portfolio cash value
-// and log it in the books, and assigns a random id to the new trader
-Trader::Trader(double init_cash) : V(init_cash) {
-	portfolio_value.push_back(init_cash);
-	
-	// Generate a random 8-bit string for trader id
-	// The probability that two traders share the same id is 2^-8
-	std::uniform_int<int> dist(0, 1);
-	std::mt19937 eng;
-	unsigned i = 0; 
-	for (; i < 8; ++i) {
-		// Generate pure randomness as per the system clock in every iteration
-		eng.seed(std::chrono::system_clock::now().time_since_epoch().count());
-		t_id += std::to_string(dist(eng));
-	}
+// Parameter constructor to initialize the portfolio cash value and the statistics,
+// allocates the history ring, and assigns a unique id to the new trader
+Trader::Trader(double init_cash, std::size_t history_length) : history(nullptr), history_size(history_length), history_next(0),
+	V(to_cash(init_cash)), buying_power(to_cash(init_cash)), t_id(IdGenerator<Trader>::next()), reports(nullptr) {
+	running.initial = running.cash = running.peak = V.load(std::memory_order_relaxed);
+	if (history_size != 0)
+		history = new Cash[history_size];
 }
 
 // Static private member initialization
 // Trivially set to $1000 
-double Trader::lower_bound = 1000.0;
+Cash Trader::lower_bound = 1000 * cash_scale;
 
 // Methods that checks whether or not a transaction 
 // is valid and the trader eligible to trade
 bool Trader::canTrade() {
-	return V >= lower_bound;
+	return V.load(std::memory_order_relaxed) >= lower_bound;
 }
 
-// Buy method that executes a trade
-bool Trader::buy(double price, long quantity) {
+// Buy method that executes a trade of the given notional
+bool Trader::buy(Cash trade_price) {
 	// Check financial eligibility of trader
 	if (!canTrade()) {
 		std::cerr << "Trader with id: " << t_id << " cannot trade!\n";
 		return false;
 	}
 
-	double trade_price = price * (double)quantity;
-
 	// Check financial eligibility of request (transaction)
-	if (trade_price > V) {
+	if (!reserve(trade_price)) {
 		std::cerr << "Trader with id: " << t_id << " cannot perform this transaction!\n";
 		return false;
 	}
 
 	// If all is legal, trade and log the trade
-	V -= trade_price;
-	portfolio_value.push_back(V);
+	settle_buy(trade_price, trade_price);
 	return true;
 }
 
-// Sell method that executes a trade
-bool Trader::sell(double price, long quantity) {
+// Sell method that executes a trade of the given notional
+bool Trader::sell(Cash trade_price) {
 	// Check financial eligibility of trader
 	if (!canTrade()) {
 		std::cerr << "Trader with id: " << t_id << " cannot trade!\n";
 		return false;
 	}
 
-	double trade_price = price * (double)quantity;
-
 	// Check financial eligibility of request (transaction)
-	if (trade_price > V) {
+	if (!reserve(trade_price)) {
 		std::cerr << "Trader with id: " << t_id << " cannot perform this transaction!\n";
 		return false;
 	}
 
 	// If all is legal, trade and log the trade
-	V += trade_price;
-	portfolio_value.push_back(V);
+	settle_sell(trade_price, trade_price);
+	return true;
+}
+
+// Front-end versions of buy and sell: the price is converted to minor units
+// once, then the notional is an integer product
+bool Trader::buy(double price, long quantity) {
+	return buy(to_cash(price) * (Cash)quantity);
+}
+
+bool Trader::sell(double price, long quantity) {
+	return sell(to_cash(price) * (Cash)quantity);
+}
+
+// Reserve method. The buying power is taken with a compare-and-swap, thus two engines
+// reserving for the same trader at once can never overdraw it
+bool Trader::reserve(Cash amount) {
+	if (!canTrade())
+		return false;
+
+	Cash available = buying_power.load(std::memory_order_relaxed);
+	do {
+		if (amount > available)
+			return false;
+	} while (!buying_power.compare_exchange_weak(available, available - amount, std::memory_order_relaxed));
 	return true;
 }
 
-// Reimburse method adds value to the trader's cash position
-void Trader::reimburse(double value) {
-	V += value;
+// Release method adds a reservation back to the buying power
+void Trader::release(Cash amount) {
+	buying_power.fetch_add(amount, std::memory_order_relaxed);
 }
 
-// Getter method that returns the current portfolio value
+// Settlement of a buy: the notional leaves the cash, and what was reserved
+// beyond it goes back to the buying power
+void Trader::settle_buy(Cash notional, Cash reserved) {
+	Cash value = V.fetch_sub(notional, std::memory_order_relaxed) - notional;
+	if (reserved != notional)
+		buying_power.fetch_add(reserved - notional, std::memory_order_relaxed);
+	log(value, -notional);
+}
+
+// Settlement of a sell: the notional is added to the cash, and to the
+// buying power along with the reservation
+void Trader::settle_sell(Cash notional, Cash reserved) {
+	Cash value = V.fetch_add(notional, std::memory_order_relaxed) + notional;
+	buying_power.fetch_add(reserved + notional, std::memory_order_relaxed);
+	log(value, notional);
+}
+
+// Logs a transaction in O(1): the statistics are updated in place and the margin
+// overwrites the oldest one in the history ring
+void Trader::log(Cash value, Cash margin) {
+	std::unique_lock<std::mutex> lock(portfolio_mt);
+
+	if (margin < 0)
+		running.bought -= margin;
+	else
+		running.sold += margin;
+
+	running.min_margin = running.transactions == 0 || margin < running.min_margin ? margin : running.min_margin;
+	running.max_margin = running.transactions == 0 || margin > running.max_margin ? margin : running.max_margin;
+	running.last_margin = margin;
+	++running.transactions;
+
+	if (value > running.peak)
+		running.peak = value;
+	if (running.peak - value > running.drawdown)
+		running.drawdown = running.peak - value;
+
+	if (history != nullptr) {
+		history[history_next % history_size] = margin;
+		++history_next;
+	}
+}
+
+// Getter method that returns the current portfolio value, in dollars
 const double Trader::currentValue() {
-	return V;
+	return to_dollars(V.load(std::memory_order_relaxed));
+}
+
+// Getter method that returns the current portfolio value, in minor units
+const Cash Trader::cash() {
+	return V.load(std::memory_order_relaxed);
+}
+
+// Getter method that returns the cash not reserved by live orders, in minor units
+const Cash Trader::buyingPower() {
+	return buying_power.load(std::memory_order_relaxed);
 }
 
 // Getter method that returns the trader's id
-const std::string Trader::getId() {
+const std::uint64_t Trader::getId() {
 	return t_id;
 }
 
-// Additional feature that computes and returns the margins
-// of each transaction
+// Subscribes to the execution reports of the trader's orders
+void Trader::subscribe(ExecutionReports * subscription) {
+	reports.store(subscription, std::memory_order_release);
+}
+
+// Additional feature that returns the margins of the transactions
+// still in the history ring, oldest first
 const std::vector<double> Trader::getMargins() {
 
 	std::vector<double> margins;
+	std::unique_lock<std::mutex> lock(portfolio_mt);
 
-	// Iterate and compute portfolio value flunctuations	
-	auto begin	= portfolio_value.begin();
-	auto end	= portfolio_value.end();
-	auto iter	= begin + 1;
-
-	while (iter != end) {
-		margins.push_back(*iter - *begin);
-		++iter; ++begin;
-	}
+	// The ring is full once it wrapped, and its oldest margin is the next to be overwritten
+	std::size_t count = history_next < history_size ? history_next : history_size;
+	std::size_t i = history_next - count;
+	for (; i < history_next; ++i)
+		margins.push_back(to_dollars(history[i % history_size]));
 	return margins;
 }
 
+// Getter method that returns the running statistics of the account.
+// Cash, its change since the opening and exposure are read from the account itself
+const TraderStats Trader::stats() {
+	std::unique_lock<std::mutex> lock(portfolio_mt);
+	TraderStats s = running;
+	s.cash = V.load(std::memory_order_relaxed);
+	s.cash_change = s.cash - s.initial;
+	s.exposure = s.cash - buying_power.load(std::memory_order_relaxed);
+	return s;
+}
+
 // Method to display the trader's info
 void Trader::info() {
 	std::cout 
 		<< "Trader ID: "
 		<< t_id
 		<< "\nCash position: " 
-		<< V
+		<< to_dollars(V.load(std::memory_order_relaxed))
 		<< "\nTrading Eligibility: " 
 		<< std::boolalpha << canTrade();
 }
 
-// Default destructor is ok -- no heap allocation
-Trader::~Trader() = default;
\ No newline at end of file
+// The destructor reclaims the history ring
+Trader::~Trader() {
+	delete[] history;
+}
\ No newline at end of file
@@ -18,6 +18,37 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <atomic>
+#include <mutex>
+
+#include "FixedPoint.hpp"
+#include "IdGenerator.hpp"
+
+class ExecutionReports;
+
+//*** TraderStats data structure ***//
+
+// Running statistics of a trader's account, in minor units. They are updated in O(1)
+// on every transaction, thus they cost the same on the first trade of the day and on
+// the millionth, and take no memory beyond this struct
+struct TraderStats {
+	Cash			initial;		// Cash at opening
+	Cash			cash;			// Cash now
+	Cash			cash_change;	// cash - initial. Positions are not tracked, thus this is
+									// not a P&L: shares bought count as a loss until sold
+	Cash			exposure;		// Cash reserved by live orders
+	Cash			bought;			// Total notional bought
+	Cash			sold;			// Total notional sold
+	std::size_t		transactions;	// Number of fills settled
+	Cash			last_margin;	// Change of cash of the last transaction
+	Cash			min_margin;		// Smallest change of cash of a transaction
+	Cash			max_margin;		// Largest change of cash of a transaction
+	Cash			peak;			// Highest cash so far
+	Cash			drawdown;		// Largest drop of cash from a peak
+
+	TraderStats() : initial(0), cash(0), cash_change(0), exposure(0), bought(0), sold(0), transactions(0),
+		last_margin(0), min_margin(0), max_margin(0), peak(0), drawdown(0) {}
+};
 
 //*** Trader class definition ***//
 
@@ -28,8 +59,10 @@
 // The $1000 minimum was trivially selected for the system demo. 
 //
 // A trader, once instantiated with a proper available trading amount V, can start
-// selling or buying stocks, with each transaction being logged in the portfolio_value vector.
-// Additionally, there is a feature which returns the margins of all transactions.
+// selling or buying stocks, with each transaction updating the running statistics of the
+// account (cash change, exposure, margins) in O(1). The margins of the last transactions are also
+// kept in a fixed-size ring, sized on construction (0 disables it): an active account keeps
+// the same footprint all day. The full history of fills is in the Fill book and the journals.
 //
 //*** Assumptions:
 //			1) We do not check whether or not a trader has a certain stock he/she wants to sell.
@@ -39,40 +72,96 @@
 //			3) For the sake of the demonstration, every trader starts with a random amount between
 //			   $500,000 - $1,000,000 
 //			   *to be handled by another thread, and not the constructor!
+//
+// The cash position is kept in integer minor units (see FixedPoint.hpp), thus settling a
+// trade never accumulates rounding errors. Dollars are only used by the front-end methods.
+//
+// Credit is checked before an order reaches the book: the Exchange reserves the notional
+// of every order out of the trader's buying power when it is submitted, and rejects the
+// order if the trader can't cover it. A fill then settles against the reservation and
+// can't fail, thus the matching engine never rolls a trade back and never prints.
+// Orders that won't fill (deleted, cancelled, killed) give their reservation back.
+// The cash and the buying power are atomics, thus a trader can trade on several matching
+// engines at once.
+//
+// A trader can subscribe to the execution reports of its orders (ExecutionReport.hpp):
+// fills, partial fills, cancels and rejects are pushed into the subscription as they happen.
 class Trader {
 public:
-	// Parameter constructor since a default initial cash position is not defined
-	Trader(double init_cash);
+	// Number of margins kept by default
+	static const std::size_t default_history = 1024;
+
+	// Parameter constructor since a default initial cash position is not defined.
+	// The trader keeps the margins of its last history_length transactions
+	Trader(double init_cash, std::size_t history_length = default_history);
 
-	// Default destructor since there is no heap allocation
+	// The destructor reclaims the history ring
 	~Trader();
 
-	// Methods to execute trades
+	// Methods to execute trades at once, checked like an order: the trader must be eligible
+	// and cover the notional out of the buying power. The price/quantity versions are the
+	// front end, in dollars
+	bool buy(Cash notional);
+	bool sell(Cash notional);
 	bool buy(double price, long quantity);
 	bool sell(double price, long quantity);
 
-	// Reimburse method in case a trade fails
-	void reimburse(double value);
+	// Pre-trade credit check. Reserves an amount out of the buying power, atomically.
+	// Returns false, and reserves nothing, if the trader can't trade or can't cover it
+	bool reserve(Cash amount);
+
+	// Gives back the reservation of an order, or of the part of it that won't fill
+	void release(Cash amount);
+
+	// Settle a fill of the given notional against the given reservation. They can't fail.
+	// A buyer filled below its limit gets the difference back to its buying power
+	void settle_buy(Cash notional, Cash reserved);
+	void settle_sell(Cash notional, Cash reserved);
 
 	// Auxiliary features
-	const std::vector<double> getMargins();
-	const double currentValue();
-	const std::string getId();
+	const std::vector<double> getMargins();	// Of the transactions in the history, oldest first, in dollars
+	const TraderStats stats();				// Running statistics, in minor units
+	const double currentValue();			// In dollars
+	const Cash cash();						// In minor units
+	const Cash buyingPower();				// Cash not reserved by live orders, in minor units
+	const std::uint64_t getId();
 	bool canTrade();
 	void info();
 
+	// Execution reports of the trader's orders go to the given subscription from now on,
+	// nullptr stops them. The subscription belongs to the client and must outlive the
+	// trader's orders, like the trader itself
+	void subscribe(ExecutionReports * reports);
+
+	// Current subscription, nullptr if none. Read by the engines on every event, thus inline
+	inline ExecutionReports* subscription() {
+		return reports.load(std::memory_order_acquire);
+	}
+
 private:
 	// A unique lower trading cash amount is defined for all Trader instances
-	static double lower_bound;
+	static Cash lower_bound;
+
+	// Running statistics and the ring of the last margins. Fills settle on the
+	// matching threads, thus they are updated under a lock
+	TraderStats running;
+	Cash* history;
+	std::size_t history_size;
+	std::size_t history_next;			// Slot of the next margin
+	std::mutex portfolio_mt;
+
+	// Cash value and buying power, in minor units
+	std::atomic<Cash> V;
+	std::atomic<Cash> buying_power;
 
-	// Log the portfolio cash values after each transaction
-	std::vector<double> portfolio_value;
+	// Logs a transaction: the cash after it and its change of cash
+	void log(Cash value, Cash margin);
 
-	// Cash value
-	double V;
+	// Trader id, unique among the traders of the process
+	std::uint64_t t_id;
 
-	// Trader id
-	std::string t_id;
+	// Where the execution reports go
+	std::atomic<ExecutionReports*> reports;
 
 private:
 	// No copies of Trader objects are allowed: you cannot replicate an existing trader account
@@ -145,5 +145,56 @@ int main() {
 
 	// Success! 
 
+	// Test 6: Reserve cash for orders, then settle fills against the reservations.
+	// A trader with $10'000 can't reserve more than that, and a buy filled below its
+	// limit gets the difference back to its buying power
+	std::cout << "*** Test 6:\n\n";
+	Trader t6(10'000);
+
+	bool first = t6.reserve(to_cash(6'000));
+	bool second = t6.reserve(to_cash(6'000));
+	std::cout << "Reserve $6000: " << first << ", reserve another $6000: " << second << " (expected true, false)\n";
+	std::cout << "Buying power: $" << to_dollars(t6.buyingPower()) << " (expected 4000)\n";
+
+	t6.settle_buy(to_cash(5'000), to_cash(6'000));
+	std::cout << "Bought $5000 against $6000. V: $" << t6.currentValue() << ", buying power: $" << to_dollars(t6.buyingPower()) << " (expected 5000, 5000)\n";
+
+	t6.reserve(to_cash(2'000));
+	t6.settle_sell(to_cash(2'000), to_cash(2'000));
+	std::cout << "Sold $2000. V: $" << t6.currentValue() << ", buying power: $" << to_dollars(t6.buyingPower()) << " (expected 7000, 7000)\n";
+
+	t6.reserve(to_cash(3'000));
+	t6.release(to_cash(3'000));
+	std::cout << "Reserved and released $3000. Buying power: $" << to_dollars(t6.buyingPower()) << " (expected 7000)\n\n";
+
+	// Success!
+
+	// Test 7: Keep the margins of the last 4 transactions only, while the running
+	// statistics cover all of them
+	std::cout << "*** Test 7:\n\n";
+	Trader t7(100'000, 4);
+
+	t7.buy(100.0, 100);		// -10000
+	t7.sell(150.0, 100);	// +15000
+	t7.buy(50.0, 100);		// -5000
+	t7.sell(20.0, 100);		// +2000
+	t7.buy(300.0, 100);		// -30000
+	t7.sell(10.0, 100);		// +1000
+
+	auto t7_margins = t7.getMargins();
+	std::cout << "Trader 7 margins:\n";
+	for (double & e : t7_margins)
+		std::cout << e << " ";
+	std::cout << "(expected -5000 2000 -30000 1000)\n";
+
+	TraderStats s7 = t7.stats();
+	std::cout << "Transactions: " << s7.transactions << ", cash change: $" << to_dollars(s7.cash_change)
+		<< ", bought: $" << to_dollars(s7.bought) << ", sold: $" << to_dollars(s7.sold) << "\n";
+	std::cout << "Margins: min $" << to_dollars(s7.min_margin) << ", max $" << to_dollars(s7.max_margin)
+		<< ", drawdown: $" << to_dollars(s7.drawdown) << ", exposure: $" << to_dollars(s7.exposure) << "\n";
+	std::cout << "(expected 6, -27000, 45000, 18000, -30000, 15000, 33000, 0)\n\n";
+
+	// Success!
+
 	return 0;
 }
\ No newline at end of file